@@ -6,22 +6,49 @@ Creation Date/Time: 2025-03-27 15:07:53 UTC
 
 import esphome.codegen as cg
 import esphome.config_validation as cv
-from esphome.components import uart, sensor, binary_sensor, button
+from esphome import automation
+from esphome.core import CORE
+from esphome.components import uart, sensor, binary_sensor, button, number, select, text_sensor
 from esphome.const import (
     CONF_ID,
     CONF_THROTTLE,
     CONF_DISTANCE,
     CONF_NAME,
+    CONF_TYPE,
+    CONF_SIZE,
+    CONF_ENERGY,
+    CONF_UPDATE_INTERVAL,
     DEVICE_CLASS_DISTANCE,
     DEVICE_CLASS_OCCUPANCY,
     DEVICE_CLASS_RUNNING,
+    ENTITY_CATEGORY_DIAGNOSTIC,
     STATE_CLASS_MEASUREMENT,
+    STATE_CLASS_TOTAL_INCREASING,
     UNIT_METER,
+    UNIT_MILLISECOND,
     ICON_MOTION_SENSOR,
+    ICON_CHIP,
 )
 
+DOMAIN = 'hlk_ld2410s'
 DEPENDENCIES = ['uart']
-AUTO_LOAD = ['sensor', 'binary_sensor', 'button']
+MULTI_CONF = True
+
+def AUTO_LOAD():
+    # Entity platforms are only built when some radar uses them, so a simple
+    # presence node does not pay for number, select and text_sensor
+    if CORE.raw_config is None:
+        return ['sensor', 'binary_sensor', 'button', 'number', 'select', 'text_sensor']
+    configs = CORE.raw_config.get(DOMAIN) or []
+    if isinstance(configs, dict):
+        configs = [configs]
+    configs = [conf for conf in configs if isinstance(conf, dict)]
+    load = ['sensor', 'binary_sensor', 'button']
+    if any(CONF_CONTROLS in conf for conf in configs):
+        load += ['number', 'select']
+    if any(CONF_FIRMWARE_VERSION in conf for conf in configs):
+        load.append('text_sensor')
+    return load
 
 hlk_ld2410s_ns = cg.esphome_ns.namespace('hlk_ld2410s')
 HLKLD2410SComponent = hlk_ld2410s_ns.class_(
@@ -29,6 +56,16 @@ HLKLD2410SComponent = hlk_ld2410s_ns.class_(
 )
 EnableConfigButton = hlk_ld2410s_ns.class_('EnableConfigButton', button.Button)
 DisableConfigButton = hlk_ld2410s_ns.class_('DisableConfigButton', button.Button)
+CalibrateButton = hlk_ld2410s_ns.class_('CalibrateButton', button.Button)
+DiagnosticSensor = hlk_ld2410s_ns.enum('DiagnosticSensor', is_class=True)
+GateAggregate = hlk_ld2410s_ns.enum('GateAggregate', is_class=True)
+Control = hlk_ld2410s_ns.enum('Control', is_class=True)
+ControlNumber = hlk_ld2410s_ns.class_('ControlNumber', number.Number)
+OutputModeSelect = hlk_ld2410s_ns.class_('OutputModeSelect', select.Select)
+ResponseSpeedSelect = hlk_ld2410s_ns.class_('ResponseSpeedSelect', select.Select)
+ConfigureAction = hlk_ld2410s_ns.class_('ConfigureAction', automation.Action)
+SetGateThresholdsAction = hlk_ld2410s_ns.class_('SetGateThresholdsAction', automation.Action)
+DumpFlightRecorderAction = hlk_ld2410s_ns.class_('DumpFlightRecorderAction', automation.Action)
 
 # Configuration Constants
 CONF_UART_ID = 'uart_id'
@@ -50,6 +87,94 @@ CONF_TRIGGER_FACTOR = 'trigger_factor'
 CONF_HOLD_FACTOR = 'hold_factor'
 CONF_SCAN_TIME = 'scan_time'
 CONF_GATE_ENERGY = 'gate_{}_energy'
+CONF_GATE_ENERGY_WINDOW = 'gate_energy_window'
+CONF_AGGREGATE = 'aggregate'
+CONF_DISTANCE_FILTER = 'distance_filter'
+CONF_CALIBRATION = 'calibration'
+CONF_DURATION = 'duration'
+CONF_TRIGGER_SIGMA = 'trigger_sigma'
+CONF_HOLD_SIGMA = 'hold_sigma'
+CONF_START = 'start'
+CONF_TRIGGER_THRESHOLD = 'gate_{}_trigger_threshold'
+CONF_HOLD_THRESHOLD = 'gate_{}_hold_threshold'
+CONF_WINDOW_SIZE = 'window_size'
+CONF_ALPHA = 'alpha'
+CONF_BETA = 'beta'
+CONF_DISTANCE_DEADBAND = 'distance_deadband'
+CONF_MAX_SILENCE = 'max_silence'
+CONF_TRACE = 'trace'
+CONF_DIAGNOSTICS = 'diagnostics'
+CONF_RX_TASK = 'rx_task'
+CONF_FORCE_RECONFIGURE = 'force_reconfigure'
+CONF_CONTROLS = 'controls'
+CONF_CONFIG_DEBOUNCE = 'config_debounce'
+CONF_GATE = 'gate'
+CONF_TRIGGER = 'trigger'
+CONF_HOLD = 'hold'
+CONF_FLIGHT_RECORDER = 'flight_recorder'
+CONF_FIRMWARE_VERSION = 'firmware_version'
+CONF_LOOP_BUDGET = 'loop_budget'
+CONF_ZONES = 'zones'
+CONF_FIRST_GATE = 'first_gate'
+CONF_LAST_GATE = 'last_gate'
+CONF_ZONE_TRIGGER = 'trigger_threshold'
+CONF_ZONE_HOLD = 'hold_threshold'
+CONF_OCCUPANCY = 'occupancy'
+MAX_ZONES = 8
+CONF_ADAPTIVE_REPORT = 'adaptive_report'
+CONF_IDLE_FREQUENCY = 'idle_frequency'
+CONF_ACTIVE_FREQUENCY = 'active_frequency'
+CONF_IDLE_AFTER = 'idle_after'
+UNIT_MICROSECOND = 'µs'
+
+# Hot-path trace levels, compiled in via HLK_LD2410S_TRACE_LEVEL
+TRACE_LEVELS = {
+    'off': 0,
+    'counters': 1,
+    'sampled': 2,
+    'full': 3,
+}
+
+# Per-sensor aggregate published when a gate energy window closes
+GATE_AGGREGATES = {
+    'min': GateAggregate.MIN,
+    'max': GateAggregate.MAX,
+    'mean': GateAggregate.MEAN,
+    'variance': GateAggregate.VARIANCE,
+}
+
+# Runtime number entities: (C++ enum member, min, max, step)
+CONTROL_NUMBERS = {
+    CONF_UNMANNED_DELAY: ('UNMANNED_DELAY', 10, 120, 1),
+    CONF_STATUS_REPORT_FREQUENCY: ('STATUS_REPORT_FREQUENCY', 0.5, 8.0, 0.5),
+    CONF_DISTANCE_REPORT_FREQUENCY: ('DISTANCE_REPORT_FREQUENCY', 0.5, 8.0, 0.5),
+    CONF_FARTHEST_GATE: ('FARTHEST_GATE', 1, 16, 1),
+    CONF_NEAREST_GATE: ('NEAREST_GATE', 0, 15, 1),
+}
+OUTPUT_MODE_OPTIONS = ['Simple', 'Engineering']
+RESPONSE_SPEED_OPTIONS = ['Normal', 'Fast']
+
+# Link health sensors: (C++ enum member, unit, state class)
+DIAGNOSTIC_SENSORS = {
+    'simple_frames': ('SIMPLE_FRAMES', None, STATE_CLASS_TOTAL_INCREASING),
+    'engineering_frames': ('ENGINEERING_FRAMES', None, STATE_CLASS_TOTAL_INCREASING),
+    'resync_bytes': ('RESYNC_BYTES', None, STATE_CLASS_TOTAL_INCREASING),
+    'bad_footers': ('BAD_FOOTERS', None, STATE_CLASS_TOTAL_INCREASING),
+    'buffer_overflows': ('BUFFER_OVERFLOWS', None, STATE_CLASS_TOTAL_INCREASING),
+    'ack_timeouts': ('ACK_TIMEOUTS', None, STATE_CLASS_TOTAL_INCREASING),
+    'failed_responses': ('FAILED_RESPONSES', None, STATE_CLASS_TOTAL_INCREASING),
+    'rx_queue_overflows': ('RX_QUEUE_OVERFLOWS', None, STATE_CLASS_TOTAL_INCREASING),
+    'budget_exhausted': ('BUDGET_EXHAUSTED', None, STATE_CLASS_TOTAL_INCREASING),
+    'ack_latency_min': ('ACK_LATENCY_MIN', UNIT_MILLISECOND, STATE_CLASS_MEASUREMENT),
+    'ack_latency_avg': ('ACK_LATENCY_AVG', UNIT_MILLISECOND, STATE_CLASS_MEASUREMENT),
+    'ack_latency_max': ('ACK_LATENCY_MAX', UNIT_MILLISECOND, STATE_CLASS_MEASUREMENT),
+    'loop_time_p50': ('LOOP_TIME_P50', UNIT_MICROSECOND, STATE_CLASS_MEASUREMENT),
+    'loop_time_p95': ('LOOP_TIME_P95', UNIT_MICROSECOND, STATE_CLASS_MEASUREMENT),
+    'loop_time_p99': ('LOOP_TIME_P99', UNIT_MICROSECOND, STATE_CLASS_MEASUREMENT),
+    'presence_latency_min': ('PRESENCE_LATENCY_MIN', UNIT_MICROSECOND, STATE_CLASS_MEASUREMENT),
+    'presence_latency_avg': ('PRESENCE_LATENCY_AVG', UNIT_MICROSECOND, STATE_CLASS_MEASUREMENT),
+    'presence_latency_max': ('PRESENCE_LATENCY_MAX', UNIT_MICROSECOND, STATE_CLASS_MEASUREMENT),
+}
 
 # Validation schemas
 AUTO_THRESHOLD_SCHEMA = cv.Schema({
@@ -58,15 +183,143 @@ AUTO_THRESHOLD_SCHEMA = cv.Schema({
     cv.Required(CONF_SCAN_TIME): cv.int_range(min=10, max=250),
 })
 
+# Filter coefficients are passed to C++ as Q8 fixed point
+DISTANCE_FILTER_SCHEMA = cv.typed_schema({
+    'median': cv.Schema({
+        cv.Optional(CONF_WINDOW_SIZE, default=5): cv.int_range(min=3, max=9),
+    }),
+    'ema': cv.Schema({
+        cv.Optional(CONF_ALPHA, default=0.25): cv.float_range(min=0.01, max=1.0),
+    }),
+    'alpha_beta': cv.Schema({
+        cv.Optional(CONF_ALPHA, default=0.5): cv.float_range(min=0.01, max=1.0),
+        cv.Optional(CONF_BETA, default=0.1): cv.float_range(min=0.0, max=1.0),
+    }),
+}, lower=True)
+
+def validate_rx_task(value):
+    value = cv.boolean(value)
+    if value and not CORE.is_esp32:
+        raise cv.Invalid('rx_task is only available on ESP32')
+    return value
+
+def to_q8(value):
+    return int(round(value * 256))
+
+def validate_calibration(config):
+    if config[CONF_HOLD_SIGMA] > config[CONF_TRIGGER_SIGMA]:
+        raise cv.Invalid('hold_sigma must not be larger than trigger_sigma')
+    return config
+
+THRESHOLD_SENSOR_SCHEMA = sensor.sensor_schema(
+    accuracy_decimals=0,
+    entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+)
+
+CALIBRATION_SCHEMA = cv.All(cv.Schema({
+    cv.Optional(CONF_DURATION, default='60s'): cv.All(
+        cv.positive_time_period_milliseconds,
+        cv.Range(min=cv.TimePeriod(seconds=5)),
+    ),
+    cv.Optional(CONF_TRIGGER_SIGMA, default=3.0): cv.float_range(min=0.0, max=10.0),
+    cv.Optional(CONF_HOLD_SIGMA, default=2.0): cv.float_range(min=0.0, max=10.0),
+    cv.Optional(CONF_START): button.button_schema(class_=CalibrateButton),
+    **{
+        cv.Optional(key.format(i)): THRESHOLD_SENSOR_SCHEMA
+        for key in (CONF_TRIGGER_THRESHOLD, CONF_HOLD_THRESHOLD)
+        for i in range(16)
+    },
+}), validate_calibration)
+
+CONTROLS_SCHEMA = cv.Schema({
+    cv.Optional(CONF_CONFIG_DEBOUNCE, default='1s'): cv.positive_time_period_milliseconds,
+    cv.Optional(CONF_OUTPUT_MODE): select.select_schema(OutputModeSelect),
+    cv.Optional(CONF_RESPONSE_SPEED): select.select_schema(ResponseSpeedSelect),
+    **{
+        cv.Optional(key): number.number_schema(ControlNumber)
+        for key in CONTROL_NUMBERS
+    },
+})
+
+def validate_adaptive_report(config):
+    if config[CONF_IDLE_FREQUENCY] > config[CONF_ACTIVE_FREQUENCY]:
+        raise cv.Invalid('idle_frequency must not be larger than active_frequency')
+    return config
+
+# Replaces both report frequencies at runtime, driven by presence
+ADAPTIVE_REPORT_SCHEMA = cv.All(cv.Schema({
+    cv.Optional(CONF_IDLE_FREQUENCY, default=0.5): cv.float_range(min=0.5, max=8.0),
+    cv.Optional(CONF_ACTIVE_FREQUENCY, default=8.0): cv.float_range(min=0.5, max=8.0),
+    cv.Optional(CONF_IDLE_AFTER, default='60s'): cv.All(
+        cv.positive_time_period_milliseconds,
+        cv.Range(min=cv.TimePeriod(seconds=5)),
+    ),
+}), validate_adaptive_report)
+
+FLIGHT_RECORDER_SCHEMA = cv.Schema({
+    cv.Optional(CONF_SIZE, default=2048): cv.int_range(min=512, max=16384),
+})
+
+DIAGNOSTICS_SCHEMA = cv.Schema({
+    cv.Optional(CONF_UPDATE_INTERVAL, default='60s'): cv.positive_time_period_milliseconds,
+    **{
+        cv.Optional(key): sensor.sensor_schema(
+            unit_of_measurement=unit,
+            accuracy_decimals=0,
+            state_class=state_class,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        )
+        for key, (_, unit, state_class) in DIAGNOSTIC_SENSORS.items()
+    },
+})
+
+GATE_ENERGY_SENSOR_SCHEMA = sensor.sensor_schema(
+    accuracy_decimals=0,
+    state_class=STATE_CLASS_MEASUREMENT,
+    icon=ICON_MOTION_SENSOR,
+).extend({
+    cv.Optional(CONF_AGGREGATE, default='mean'): cv.enum(GATE_AGGREGATES, lower=True),
+})
+
+def validate_zone(config):
+    if config[CONF_FIRST_GATE] > config[CONF_LAST_GATE]:
+        raise cv.Invalid(f"{CONF_FIRST_GATE} must not be after {CONF_LAST_GATE}")
+    if config[CONF_ZONE_HOLD] > config[CONF_ZONE_TRIGGER]:
+        raise cv.Invalid(f"{CONF_ZONE_HOLD} must not exceed {CONF_ZONE_TRIGGER}")
+    return config
+
+# A zone is a gate range with its own occupancy and energy, derived from engineering frames
+ZONE_SCHEMA = cv.All(cv.Schema({
+    cv.Required(CONF_FIRST_GATE): cv.int_range(min=0, max=15),
+    cv.Required(CONF_LAST_GATE): cv.int_range(min=0, max=15),
+    cv.Optional(CONF_ZONE_TRIGGER, default=40): cv.int_range(min=0, max=100),
+    cv.Optional(CONF_ZONE_HOLD, default=30): cv.int_range(min=0, max=100),
+    cv.Optional(CONF_OCCUPANCY): binary_sensor.binary_sensor_schema(
+        device_class=DEVICE_CLASS_OCCUPANCY,
+    ),
+    cv.Optional(CONF_ENERGY): GATE_ENERGY_SENSOR_SCHEMA,
+}), validate_zone)
+
 CONFIG_SCHEMA = cv.Schema({
     cv.GenerateID(): cv.declare_id(HLKLD2410SComponent),
     cv.Required(CONF_UART_ID): cv.use_id(uart.UARTComponent),
     cv.Optional(CONF_THROTTLE, default='50ms'): cv.positive_time_period_milliseconds,
+    cv.Optional(CONF_DISTANCE_DEADBAND, default='0m'): cv.distance,
+    cv.Optional(CONF_MAX_SILENCE, default='0s'): cv.positive_time_period_milliseconds,
+    cv.Optional(CONF_DISTANCE_FILTER): DISTANCE_FILTER_SCHEMA,
+    cv.Optional(CONF_GATE_ENERGY_WINDOW, default='10s'): cv.positive_time_period_milliseconds,
+    cv.Optional(CONF_RX_TASK, default=False): validate_rx_task,
+    cv.Optional(CONF_LOOP_BUDGET, default='1ms'): cv.All(
+        cv.positive_time_period_microseconds,
+        cv.Range(min=cv.TimePeriod(microseconds=100), max=cv.TimePeriod(milliseconds=20)),
+    ),
+    cv.Optional(CONF_TRACE, default='off'): cv.one_of(*TRACE_LEVELS, lower=True),
+    cv.Optional(CONF_FORCE_RECONFIGURE, default=False): cv.boolean,
     cv.Optional(CONF_OUTPUT_MODE, default=True): cv.boolean,
     cv.Optional(CONF_RESPONSE_SPEED, default=5): cv.one_of(5, 10),
     cv.Optional(CONF_UNMANNED_DELAY, default=40): cv.int_range(min=10, max=120),
-    cv.Optional(CONF_STATUS_REPORT_FREQUENCY, default=0.5): cv.float_range(min=0.5, max=8.0),
-    cv.Optional(CONF_DISTANCE_REPORT_FREQUENCY, default=0.5): cv.float_range(min=0.5, max=8.0),
+    cv.Optional(CONF_STATUS_REPORT_FREQUENCY): cv.float_range(min=0.5, max=8.0),
+    cv.Optional(CONF_DISTANCE_REPORT_FREQUENCY): cv.float_range(min=0.5, max=8.0),
     cv.Optional(CONF_FARTHEST_GATE, default=12): cv.int_range(min=1, max=16),
     cv.Optional(CONF_NEAREST_GATE, default=0): cv.int_range(min=0, max=15),
     cv.Optional(CONF_TRIGGER_THRESHOLDS): cv.All(
@@ -78,6 +331,12 @@ CONFIG_SCHEMA = cv.Schema({
         cv.Length(min=16, max=16),
     ),
     cv.Optional(CONF_AUTO_THRESHOLD): AUTO_THRESHOLD_SCHEMA,
+    cv.Optional(CONF_CALIBRATION): CALIBRATION_SCHEMA,
+    cv.Optional(CONF_CONTROLS): CONTROLS_SCHEMA,
+    cv.Optional(CONF_DIAGNOSTICS): DIAGNOSTICS_SCHEMA,
+    cv.Optional(CONF_FLIGHT_RECORDER): FLIGHT_RECORDER_SCHEMA,
+    cv.Optional(CONF_ADAPTIVE_REPORT): ADAPTIVE_REPORT_SCHEMA,
+    cv.Optional(CONF_ZONES): cv.All(cv.ensure_list(ZONE_SCHEMA), cv.Length(min=1, max=MAX_ZONES)),
     cv.Optional(CONF_DISTANCE): sensor.sensor_schema(
         unit_of_measurement=UNIT_METER,
         accuracy_decimals=2,
@@ -90,6 +349,10 @@ CONFIG_SCHEMA = cv.Schema({
     cv.Optional(CONF_CONFIG_MODE): binary_sensor.binary_sensor_schema(
         device_class=DEVICE_CLASS_RUNNING,
     ),
+    cv.Optional(CONF_FIRMWARE_VERSION): text_sensor.text_sensor_schema(
+        entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        icon=ICON_CHIP,
+    ),
     cv.Optional(CONF_ENABLE_CONFIGURATION): button.button_schema(class_=EnableConfigButton),
     cv.Optional(CONF_DISABLE_CONFIGURATION): button.button_schema(class_=DisableConfigButton),
 }).extend(cv.COMPONENT_SCHEMA).extend(uart.UART_DEVICE_SCHEMA)
@@ -97,21 +360,123 @@ CONFIG_SCHEMA = cv.Schema({
 # Add gate energy sensor schemas
 for i in range(16):
     CONFIG_SCHEMA = CONFIG_SCHEMA.extend({
-        cv.Optional(CONF_GATE_ENERGY.format(i)): sensor.sensor_schema(
-            accuracy_decimals=0,
-            state_class=STATE_CLASS_MEASUREMENT,
-            icon=ICON_MOTION_SENSOR,
-        ),
+        cv.Optional(CONF_GATE_ENERGY.format(i)): GATE_ENERGY_SENSOR_SCHEMA,
     })
 
+def configure_action_sets(radar_id, key):
+    # Actions can sit in any automation, so search the whole YAML for one aimed at this radar
+    def search(node):
+        if isinstance(node, dict):
+            action = node.get('hlk_ld2410s.configure')
+            if isinstance(action, dict) and key in action and action.get(CONF_ID) in (None, radar_id):
+                return True
+            return any(search(value) for value in node.values())
+        if isinstance(node, list):
+            return any(search(item) for item in node)
+        return False
+    return CORE.raw_config is not None and search(CORE.raw_config)
+
+def validate_config(config):
+    if config[CONF_NEAREST_GATE] > config[CONF_FARTHEST_GATE]:
+        raise cv.Invalid(f"{CONF_NEAREST_GATE} must not be beyond {CONF_FARTHEST_GATE}")
+    # Gate energies only arrive in engineering frames; in simple mode these would never update
+    needs_engineering = [CONF_GATE_ENERGY.format(i) for i in range(16) if CONF_GATE_ENERGY.format(i) in config]
+    if CONF_ZONES in config:
+        needs_engineering.append(CONF_ZONES)
+    if (needs_engineering and not config[CONF_OUTPUT_MODE]
+            and CONF_OUTPUT_MODE not in config.get(CONF_CONTROLS, {})
+            and not configure_action_sets(config[CONF_ID].id, CONF_OUTPUT_MODE)):
+        raise cv.Invalid(f"{', '.join(needs_engineering)} need engineering output; set {CONF_OUTPUT_MODE}: true, "
+                         f"or add an {CONF_OUTPUT_MODE} control or an hlk_ld2410s.configure action that sets it")
+    # adaptive_report owns both report frequencies; a fixed value would be overridden at boot
+    if CONF_ADAPTIVE_REPORT in config:
+        fixed = [key for key in (CONF_STATUS_REPORT_FREQUENCY, CONF_DISTANCE_REPORT_FREQUENCY)
+                 if key in config or key in config.get(CONF_CONTROLS, {})
+                 or configure_action_sets(config[CONF_ID].id, key)]
+        if fixed:
+            raise cv.Invalid(f"{', '.join(fixed)} cannot be combined with {CONF_ADAPTIVE_REPORT} in the config, "
+                             f"as a control or by an hlk_ld2410s.configure action; "
+                             f"use its {CONF_IDLE_FREQUENCY} and {CONF_ACTIVE_FREQUENCY} instead")
+    return config
+
+CONFIG_SCHEMA = cv.All(CONFIG_SCHEMA, validate_config)
+
+def gate_sensor_count(config):
+    return max((i + 1 for i in range(16) if CONF_GATE_ENERGY.format(i) in config), default=0)
+
+def uses_engineering(config):
+    return (config[CONF_OUTPUT_MODE] or gate_sensor_count(config) > 0 or CONF_CALIBRATION in config
+            or CONF_ZONES in config or CONF_OUTPUT_MODE in config.get(CONF_CONTROLS, {}))
+
+def add_feature_defines():
+    # Defines are global to the build, so they are derived from every radar on
+    # the node and come out identical whichever instance emits them
+    configs = CORE.config[DOMAIN]
+    cg.add_define('HLK_LD2410S_TRACE_LEVEL', max(TRACE_LEVELS[conf[CONF_TRACE]] for conf in configs))
+    if any(conf[CONF_RX_TASK] for conf in configs):
+        cg.add_define('HLK_LD2410S_RX_TASK')
+    recorder_sizes = [conf[CONF_FLIGHT_RECORDER][CONF_SIZE] for conf in configs if CONF_FLIGHT_RECORDER in conf]
+    if recorder_sizes:
+        cg.add_define('HLK_LD2410S_RECORDER_SIZE', max(recorder_sizes))
+    if any(uses_engineering(conf) for conf in configs):
+        cg.add_define('HLK_LD2410S_ENGINEERING')
+    gate_sensors = max(gate_sensor_count(conf) for conf in configs)
+    if gate_sensors > 0:
+        cg.add_define('HLK_LD2410S_GATE_SENSORS', gate_sensors)
+    # Zones read the radar's threshold tables back to decide the way the radar does
+    if any(key in conf for conf in configs
+           for key in (CONF_TRIGGER_THRESHOLDS, CONF_HOLD_THRESHOLDS, CONF_CALIBRATION, CONF_ZONES)):
+        cg.add_define('HLK_LD2410S_THRESHOLDS')
+    if any(CONF_CALIBRATION in conf for conf in configs):
+        cg.add_define('HLK_LD2410S_CALIBRATION')
+    if any(CONF_ADAPTIVE_REPORT in conf for conf in configs):
+        cg.add_define('HLK_LD2410S_ADAPTIVE_REPORT')
+    if any(CONF_CONTROLS in conf for conf in configs):
+        cg.add_define('HLK_LD2410S_CONTROLS')
+    if any(CONF_FIRMWARE_VERSION in conf for conf in configs):
+        cg.add_define('HLK_LD2410S_FIRMWARE_SENSOR')
+    zones = max(len(conf.get(CONF_ZONES, [])) for conf in configs)
+    if zones > 0:
+        cg.add_define('HLK_LD2410S_ZONES', zones)
+
 async def to_code(config):
     var = cg.new_Pvariable(config[CONF_ID])
     await cg.register_component(var, config)
     await uart.register_uart_device(var, config)
 
+    add_feature_defines()
+
+    # Keys the stored configuration hash, so several radars on one node keep separate entries
+    cg.add(var.set_preference_key(str(config[CONF_ID].id)))
+    cg.add(var.set_force_reconfigure(config[CONF_FORCE_RECONFIGURE]))
+    cg.add(var.set_loop_budget(config[CONF_LOOP_BUDGET]))
+
+    if adaptive := config.get(CONF_ADAPTIVE_REPORT):
+        cg.add(var.set_adaptive_report(adaptive[CONF_IDLE_FREQUENCY], adaptive[CONF_ACTIVE_FREQUENCY],
+                                       adaptive[CONF_IDLE_AFTER]))
+
     if CONF_THROTTLE in config:
         cg.add(var.set_throttle(config[CONF_THROTTLE]))
 
+    if CONF_DISTANCE_DEADBAND in config:
+        cg.add(var.set_distance_deadband(config[CONF_DISTANCE_DEADBAND]))
+
+    if CONF_MAX_SILENCE in config:
+        cg.add(var.set_max_silence(config[CONF_MAX_SILENCE]))
+
+    if CONF_DISTANCE_FILTER in config:
+        filt = config[CONF_DISTANCE_FILTER]
+        if filt[CONF_TYPE] == 'median':
+            cg.add(var.set_distance_median_filter(filt[CONF_WINDOW_SIZE]))
+        elif filt[CONF_TYPE] == 'ema':
+            cg.add(var.set_distance_ema_filter(to_q8(filt[CONF_ALPHA])))
+        else:
+            cg.add(var.set_distance_alpha_beta_filter(to_q8(filt[CONF_ALPHA]), to_q8(filt[CONF_BETA])))
+
+    # The window only exists when gate sensors or zones are compiled in
+    if gate_sensor_count(config) > 0 or CONF_ZONES in config:
+        cg.add(var.set_gate_energy_window(config[CONF_GATE_ENERGY_WINDOW]))
+
     if CONF_OUTPUT_MODE in config:
         cg.add(var.set_output_mode(config[CONF_OUTPUT_MODE]))
 
@@ -158,6 +523,9 @@ async def to_code(config):
     if CONF_CONFIG_MODE in config:
         sens = await binary_sensor.new_binary_sensor(config[CONF_CONFIG_MODE])
         cg.add(var.set_config_mode_sensor(sens))
+    if CONF_FIRMWARE_VERSION in config:
+        sens = await text_sensor.new_text_sensor(config[CONF_FIRMWARE_VERSION])
+        cg.add(var.set_firmware_version_sensor(sens))
 
     if CONF_ENABLE_CONFIGURATION in config:
         conf = config[CONF_ENABLE_CONFIGURATION]
@@ -171,10 +539,118 @@ async def to_code(config):
         await button.register_button(sens, conf)
         cg.add(var.set_disable_config_button(sens))
 
+    if CONF_CALIBRATION in config:
+        cal = config[CONF_CALIBRATION]
+        cg.add(var.set_calibration_duration(cal[CONF_DURATION]))
+        cg.add(var.set_calibration_sigma(cal[CONF_TRIGGER_SIGMA], cal[CONF_HOLD_SIGMA]))
+        if CONF_START in cal:
+            conf = cal[CONF_START]
+            btn = cg.new_Pvariable(conf[CONF_ID], var)
+            await button.register_button(btn, conf)
+            cg.add(var.set_calibrate_button(btn))
+        for i in range(16):
+            if sens_conf := cal.get(CONF_TRIGGER_THRESHOLD.format(i)):
+                sens = await sensor.new_sensor(sens_conf)
+                cg.add(var.set_trigger_threshold_sensor(i, sens))
+            if sens_conf := cal.get(CONF_HOLD_THRESHOLD.format(i)):
+                sens = await sensor.new_sensor(sens_conf)
+                cg.add(var.set_hold_threshold_sensor(i, sens))
+
+    if CONF_CONTROLS in config:
+        controls = config[CONF_CONTROLS]
+        cg.add(var.set_config_debounce(controls[CONF_CONFIG_DEBOUNCE]))
+        if conf := controls.get(CONF_OUTPUT_MODE):
+            sel = cg.new_Pvariable(conf[CONF_ID], var)
+            await select.register_select(sel, conf, options=OUTPUT_MODE_OPTIONS)
+            cg.add(var.set_output_mode_select(sel))
+        if conf := controls.get(CONF_RESPONSE_SPEED):
+            sel = cg.new_Pvariable(conf[CONF_ID], var)
+            await select.register_select(sel, conf, options=RESPONSE_SPEED_OPTIONS)
+            cg.add(var.set_response_speed_select(sel))
+        for key, (member, min_value, max_value, step) in CONTROL_NUMBERS.items():
+            if conf := controls.get(key):
+                num = cg.new_Pvariable(conf[CONF_ID], var, getattr(Control, member))
+                await number.register_number(num, conf, min_value=min_value, max_value=max_value, step=step)
+                cg.add(var.set_control_number(getattr(Control, member), num))
+
+    if CONF_DIAGNOSTICS in config:
+        diag = config[CONF_DIAGNOSTICS]
+        cg.add(var.set_diagnostics_interval(diag[CONF_UPDATE_INTERVAL]))
+        for key, (member, _, _) in DIAGNOSTIC_SENSORS.items():
+            if sens_conf := diag.get(key):
+                sens = await sensor.new_sensor(sens_conf)
+                cg.add(var.set_diagnostic_sensor(getattr(DiagnosticSensor, member), sens))
+
     # Register gate energy sensors
     for i in range(16):
         if gate_conf := config.get(CONF_GATE_ENERGY.format(i)):
             sens = await sensor.new_sensor(gate_conf)
-            cg.add(var.set_gate_energy_sensor(i, sens))
+            cg.add(var.set_gate_energy_sensor(i, sens, gate_conf[CONF_AGGREGATE]))
+
+    for i, zone in enumerate(config.get(CONF_ZONES, [])):
+        cg.add(var.add_zone(zone[CONF_FIRST_GATE], zone[CONF_LAST_GATE], zone[CONF_ZONE_TRIGGER], zone[CONF_ZONE_HOLD]))
+        if occupancy_conf := zone.get(CONF_OCCUPANCY):
+            bs = await binary_sensor.new_binary_sensor(occupancy_conf)
+            cg.add(var.set_zone_occupancy_sensor(i, bs))
+        if energy_conf := zone.get(CONF_ENERGY):
+            sens = await sensor.new_sensor(energy_conf)
+            cg.add(var.set_zone_energy_sensor(i, sens, energy_conf[CONF_AGGREGATE]))
+
+# Actions, e.g. for Home Assistant API actions: (key, validator, C++ type)
+CONFIGURE_FIELDS = [
+    (CONF_OUTPUT_MODE, cv.boolean, cg.bool_),
+    (CONF_RESPONSE_SPEED, cv.one_of(5, 10, int=True), cg.uint8),
+    (CONF_UNMANNED_DELAY, cv.int_range(min=10, max=120), cg.uint8),
+    (CONF_STATUS_REPORT_FREQUENCY, cv.float_range(min=0.5, max=8.0), cg.float_),
+    (CONF_DISTANCE_REPORT_FREQUENCY, cv.float_range(min=0.5, max=8.0), cg.float_),
+    (CONF_FARTHEST_GATE, cv.int_range(min=1, max=16), cg.uint8),
+    (CONF_NEAREST_GATE, cv.int_range(min=0, max=15), cg.uint8),
+]
+
+CONFIGURE_ACTION_SCHEMA = cv.Schema({
+    cv.GenerateID(): cv.use_id(HLKLD2410SComponent),
+    **{
+        cv.Optional(key): cv.templatable(validator)
+        for key, validator, _ in CONFIGURE_FIELDS
+    },
+})
+
+@automation.register_action('hlk_ld2410s.configure', ConfigureAction, CONFIGURE_ACTION_SCHEMA)
+async def configure_action_to_code(config, action_id, template_arg, args):
+    var = cg.new_Pvariable(action_id, template_arg)
+    await cg.register_parented(var, config[CONF_ID])
+    if CONF_OUTPUT_MODE in config:
+        # The action may switch to engineering output at runtime
+        cg.add_define('HLK_LD2410S_ENGINEERING')
+    for key, _, type_ in CONFIGURE_FIELDS:
+        if key in config:
+            templ = await cg.templatable(config[key], args, type_)
+            cg.add(getattr(var, f'set_{key}')(templ))
+    return var
+
+SET_GATE_THRESHOLDS_ACTION_SCHEMA = cv.Schema({
+    cv.GenerateID(): cv.use_id(HLKLD2410SComponent),
+    cv.Required(CONF_GATE): cv.templatable(cv.int_range(min=0, max=15)),
+    cv.Required(CONF_TRIGGER): cv.templatable(cv.int_range(min=0, max=100)),
+    cv.Required(CONF_HOLD): cv.templatable(cv.int_range(min=0, max=100)),
+})
+
+@automation.register_action('hlk_ld2410s.set_gate_thresholds', SetGateThresholdsAction,
+                            SET_GATE_THRESHOLDS_ACTION_SCHEMA)
+async def set_gate_thresholds_action_to_code(config, action_id, template_arg, args):
+    var = cg.new_Pvariable(action_id, template_arg)
+    await cg.register_parented(var, config[CONF_ID])
+    cg.add_define('HLK_LD2410S_THRESHOLDS')
+    for key in (CONF_GATE, CONF_TRIGGER, CONF_HOLD):
+        templ = await cg.templatable(config[key], args, cg.uint8)
+        cg.add(getattr(var, f'set_{key}')(templ))
+    return var
+
+@automation.register_action('hlk_ld2410s.dump_flight_recorder', DumpFlightRecorderAction,
+                            automation.maybe_simple_id({cv.GenerateID(): cv.use_id(HLKLD2410SComponent)}))
+async def dump_flight_recorder_action_to_code(config, action_id, template_arg, args):
+    var = cg.new_Pvariable(action_id, template_arg)
+    await cg.register_parented(var, config[CONF_ID])
+    return var
 
 hlk_ld2410s_ns.end_namespace()
\ No newline at end of file
@@ -0,0 +1,79 @@
+/**
+ * Activity-adaptive report frequency for the HLK-LD2410S component.
+ *
+ * Runs the radar's distance reports at the active frequency while someone is
+ * present and drops them to the idle frequency once the room has been empty
+ * for idle_after. Status reports stay at the active frequency, so presence
+ * is never reported late. Presence
+ * switches back immediately; going idle needs idle_after both without
+ * presence and since the last switch, so a flickering target costs at most
+ * one round trip per idle_after.
+ *
+ * Author: mouldybread
+ */
+
+ #pragma once
+ 
+ #include <cstdint>
+ 
+ namespace esphome {
+ namespace hlk_ld2410s {
+ 
+ class ReportRateController {
+  public:
+     void configure(float idle_frequency, float active_frequency, uint32_t idle_after) {
+         this->idle_frequency_ = idle_frequency;
+         this->active_frequency_ = active_frequency;
+         this->idle_after_ = idle_after;
+         this->enabled_ = true;
+     }
+ 
+     // Only radars with adaptive_report in their YAML run the controller
+     bool enabled() const { return this->enabled_; }
+ 
+     // The radar starts at the active frequency; the idle timer runs from here
+     void start(uint32_t now) {
+         this->active_ = true;
+         this->last_presence_ = now;
+         this->last_switch_ = now;
+     }
+ 
+     // Returns the frequency to switch to, or 0 when the current one stays
+     float update(bool presence, uint32_t now) {
+         if (presence) {
+             this->last_presence_ = now;
+             if (this->active_) {
+                 return 0.0f;
+             }
+             this->active_ = true;
+             this->last_switch_ = now;
+             return this->active_frequency_;
+         }
+         if (!this->active_ || now - this->last_presence_ < this->idle_after_ ||
+             now - this->last_switch_ < this->idle_after_) {
+             return 0.0f;
+         }
+         this->active_ = false;
+         this->last_switch_ = now;
+         return this->idle_frequency_;
+     }
+ 
+     // The frequency the radar should be running at right now
+     float frequency() const { return this->active_ ? this->active_frequency_ : this->idle_frequency_; }
+     bool active() const { return this->active_; }
+     float idle_frequency() const { return this->idle_frequency_; }
+     float active_frequency() const { return this->active_frequency_; }
+     uint32_t idle_after() const { return this->idle_after_; }
+ 
+  protected:
+     float idle_frequency_{0.5f};
+     float active_frequency_{8.0f};
+     uint32_t idle_after_{60000};
+     uint32_t last_presence_{0};
+     uint32_t last_switch_{0};
+     bool active_{true};
+     bool enabled_{false};
+ };
+ 
+ }  // namespace hlk_ld2410s
+ }  // namespace esphome
\ No newline at end of file
@@ -0,0 +1,82 @@
+/**
+ * Windowed gate energy aggregation for the HLK-LD2410S component.
+ *
+ * Every engineering frame is folded into fixed-size integer accumulators and
+ * only the chosen aggregate is published when the window closes.
+ *
+ * Author: mouldybread
+ */
+
+ #pragma once
+ 
+ #include <cstdint>
+ 
+ namespace esphome {
+ namespace hlk_ld2410s {
+ 
+ enum class GateAggregate : uint8_t {
+     MIN = 0,
+     MAX,
+     MEAN,
+     VARIANCE,
+ };
+ 
+ /**
+  * Running min/max/sum/sum of squares for one gate. Energies are single bytes,
+  * so the 32-bit sum of squares cannot overflow before the sample count
+  * saturates at 0xFFFF; samples past that point are dropped.
+  */
+ class GateWindow {
+  public:
+     void add(uint8_t energy) {
+         if (this->count_ == UINT16_MAX) {
+             return;
+         }
+         if (this->count_ == 0 || energy < this->min_) {
+             this->min_ = energy;
+         }
+         if (this->count_ == 0 || energy > this->max_) {
+             this->max_ = energy;
+         }
+         this->sum_ += energy;
+         this->sum_squares_ += static_cast<uint32_t>(energy) * energy;
+         this->count_++;
+     }
+     void reset() {
+         this->min_ = 0;
+         this->max_ = 0;
+         this->sum_ = 0;
+         this->sum_squares_ = 0;
+         this->count_ = 0;
+     }
+     uint16_t count() const { return this->count_; }
+ 
+     // Only meaningful when count() > 0
+     float value(GateAggregate aggregate) const {
+         switch (aggregate) {
+             case GateAggregate::MIN:
+                 return this->min_;
+             case GateAggregate::MAX:
+                 return this->max_;
+             case GateAggregate::MEAN:
+                 return static_cast<float>(this->sum_) / this->count_;
+             case GateAggregate::VARIANCE: {
+                 // Population variance from integer moments: (n * sum(x^2) - sum(x)^2) / n^2
+                 const uint64_t n = this->count_;
+                 const uint64_t spread = n * this->sum_squares_ - static_cast<uint64_t>(this->sum_) * this->sum_;
+                 return static_cast<float>(spread) / static_cast<float>(n * n);
+             }
+         }
+         return 0.0f;
+     }
+ 
+  protected:
+     uint8_t min_{0};
+     uint8_t max_{0};
+     uint32_t sum_{0};
+     uint32_t sum_squares_{0};
+     uint16_t count_{0};
+ };
+ 
+ }  // namespace hlk_ld2410s
+ }  // namespace esphome
\ No newline at end of file
@@ -0,0 +1,74 @@
+/**
+ * Automation actions for changing HLK-LD2410S parameters at runtime and
+ * dumping the flight recorder.
+ *
+ * Author: mouldybread
+ */
+
+ #pragma once
+ 
+ #include "esphome/core/automation.h"
+ #include "hlk_ld2410s.h"
+ 
+ namespace esphome {
+ namespace hlk_ld2410s {
+ 
+ // Every field is optional; whatever is set joins the next configuration session
+ template<typename... Ts> class ConfigureAction : public Action<Ts...>, public Parented<HLKLD2410SComponent> {
+  public:
+     TEMPLATABLE_VALUE(bool, output_mode)
+     TEMPLATABLE_VALUE(uint8_t, response_speed)
+     TEMPLATABLE_VALUE(uint8_t, unmanned_delay)
+     TEMPLATABLE_VALUE(float, status_report_frequency)
+     TEMPLATABLE_VALUE(float, distance_report_frequency)
+     TEMPLATABLE_VALUE(uint8_t, farthest_gate)
+     TEMPLATABLE_VALUE(uint8_t, nearest_gate)
+ 
+     void play(Ts... x) override {
+         if (this->output_mode_.has_value()) {
+             this->parent_->update_output_mode(this->output_mode_.value(x...));
+         }
+         if (this->response_speed_.has_value()) {
+             this->parent_->update_response_speed(this->response_speed_.value(x...));
+         }
+         if (this->unmanned_delay_.has_value()) {
+             this->parent_->update_control(Control::UNMANNED_DELAY, this->unmanned_delay_.value(x...));
+         }
+         if (this->status_report_frequency_.has_value()) {
+             this->parent_->update_control(Control::STATUS_REPORT_FREQUENCY, this->status_report_frequency_.value(x...));
+         }
+         if (this->distance_report_frequency_.has_value()) {
+             this->parent_->update_control(Control::DISTANCE_REPORT_FREQUENCY,
+                                           this->distance_report_frequency_.value(x...));
+         }
+         if (this->farthest_gate_.has_value() && this->nearest_gate_.has_value()) {
+             this->parent_->update_gate_range(this->nearest_gate_.value(x...), this->farthest_gate_.value(x...));
+         } else if (this->farthest_gate_.has_value()) {
+             this->parent_->update_control(Control::FARTHEST_GATE, this->farthest_gate_.value(x...));
+         } else if (this->nearest_gate_.has_value()) {
+             this->parent_->update_control(Control::NEAREST_GATE, this->nearest_gate_.value(x...));
+         }
+     }
+ };
+ 
+ #ifdef HLK_LD2410S_THRESHOLDS
+ template<typename... Ts> class SetGateThresholdsAction : public Action<Ts...>, public Parented<HLKLD2410SComponent> {
+  public:
+     TEMPLATABLE_VALUE(uint8_t, gate)
+     TEMPLATABLE_VALUE(uint8_t, trigger)
+     TEMPLATABLE_VALUE(uint8_t, hold)
+ 
+     void play(Ts... x) override {
+         this->parent_->update_gate_thresholds(this->gate_.value(x...), this->trigger_.value(x...),
+                                               this->hold_.value(x...));
+     }
+ };
+ #endif
+ 
+ template<typename... Ts> class DumpFlightRecorderAction : public Action<Ts...>, public Parented<HLKLD2410SComponent> {
+  public:
+     void play(Ts... x) override { this->parent_->dump_flight_recorder(); }
+ };
+ 
+ }  // namespace hlk_ld2410s
+ }  // namespace esphome
\ No newline at end of file
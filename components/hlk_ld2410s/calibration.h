@@ -0,0 +1,68 @@
+/**
+ * Empty-room threshold calibration for the HLK-LD2410S component.
+ *
+ * While a scan is running every engineering frame updates a per-gate
+ * Welford mean/variance. When the scan ends, thresholds are derived as
+ * mean + k * sigma and clamped to the radar's 0-100 range.
+ *
+ * Author: mouldybread
+ */
+
+ #pragma once
+ 
+ #include <cmath>
+ #include <cstdint>
+ 
+ #include "frame_codec.h"
+ 
+ namespace esphome {
+ namespace hlk_ld2410s {
+ 
+ static const uint32_t MIN_CALIBRATION_FRAMES = 10;
+ 
+ class ThresholdCalibration {
+  public:
+     void start(uint32_t now, uint32_t duration) {
+         this->running_ = true;
+         this->started_at_ = now;
+         this->duration_ = duration;
+         this->count_ = 0;
+         for (uint8_t i = 0; i < MAX_GATES; i++) {
+             this->mean_[i] = 0.0f;
+             this->m2_[i] = 0.0f;
+         }
+     }
+     void stop() { this->running_ = false; }
+     bool running() const { return this->running_; }
+     bool finished(uint32_t now) const { return this->running_ && now - this->started_at_ >= this->duration_; }
+     uint32_t count() const { return this->count_; }
+ 
+     void add(const uint8_t *gate_energy) {
+         this->count_++;
+         for (uint8_t i = 0; i < MAX_GATES; i++) {
+             const float delta = gate_energy[i] - this->mean_[i];
+             this->mean_[i] += delta / this->count_;
+             this->m2_[i] += delta * (gate_energy[i] - this->mean_[i]);
+         }
+     }
+ 
+     // Writes MAX_GATES thresholds of mean + k * sigma into thresholds
+     void thresholds(float k, uint8_t *thresholds) const {
+         for (uint8_t i = 0; i < MAX_GATES; i++) {
+             const float sigma = this->count_ > 1 ? std::sqrt(this->m2_[i] / this->count_) : 0.0f;
+             const float value = std::round(this->mean_[i] + k * sigma);
+             thresholds[i] = value < 0.0f ? 0 : (value > 100.0f ? 100 : static_cast<uint8_t>(value));
+         }
+     }
+ 
+  protected:
+     bool running_{false};
+     uint32_t started_at_{0};
+     uint32_t duration_{0};
+     uint32_t count_{0};
+     float mean_[MAX_GATES]{};
+     float m2_[MAX_GATES]{};
+ };
+ 
+ }  // namespace hlk_ld2410s
+ }  // namespace esphome
\ No newline at end of file
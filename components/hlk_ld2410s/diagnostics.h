@@ -0,0 +1,153 @@
+/**
+ * Link health statistics for the HLK-LD2410S component.
+ *
+ * Everything here is fixed-size and allocation free so it can stay enabled
+ * in production builds.
+ *
+ * Author: mouldybread
+ */
+
+ #pragma once
+ 
+ #include <cstddef>
+ #include <cstdint>
+ #ifdef HLK_LD2410S_RX_TASK
+ #include <atomic>
+ #endif
+ 
+ #include "frame_parser.h"
+ 
+ namespace esphome {
+ namespace hlk_ld2410s {
+ 
+ // Counter written by the receive task and read by loop(); only atomic when they are different tasks
+ #ifdef HLK_LD2410S_RX_TASK
+ using TaskCounter = std::atomic<uint32_t>;
+ #else
+ using TaskCounter = uint32_t;
+ #endif
+ 
+ enum class DiagnosticSensor : uint8_t {
+     SIMPLE_FRAMES = 0,
+     ENGINEERING_FRAMES,
+     RESYNC_BYTES,
+     BAD_FOOTERS,
+     BUFFER_OVERFLOWS,
+     ACK_TIMEOUTS,
+     FAILED_RESPONSES,
+     RX_QUEUE_OVERFLOWS,
+     BUDGET_EXHAUSTED,
+     ACK_LATENCY_MIN,
+     ACK_LATENCY_AVG,
+     ACK_LATENCY_MAX,
+     LOOP_TIME_P50,
+     LOOP_TIME_P95,
+     LOOP_TIME_P99,
+     PRESENCE_LATENCY_MIN,
+     PRESENCE_LATENCY_AVG,
+     PRESENCE_LATENCY_MAX,
+     COUNT,
+ };
+ 
+ static const uint8_t DIAGNOSTIC_SENSOR_COUNT = static_cast<uint8_t>(DiagnosticSensor::COUNT);
+ 
+ // Cumulative counters for events the parser does not see itself
+ struct LinkStats {
+     uint32_t simple_frames{0};
+     uint32_t engineering_frames{0};
+     uint32_t ack_timeouts{0};
+     uint32_t failed_responses{0};
+     TaskCounter rx_queue_overflows{0};  // frames dropped between the receive task and loop()
+     uint32_t budget_exhausted{0};       // loops that left input for the next loop because of loop_budget
+ };
+ 
+ // The parser's counters as last seen by the task that owns the parser, for loop() to publish
+ struct ParserStatsSnapshot {
+     void store(const ParserStats &stats) {
+         this->discarded_bytes = stats.discarded_bytes;
+         this->bad_footers = stats.bad_footers;
+         this->overflows = stats.overflows;
+     }
+ 
+     TaskCounter discarded_bytes{0};
+     TaskCounter bad_footers{0};
+     TaskCounter overflows{0};
+ };
+ 
+ // Running min/avg/max over one publish window
+ class LatencyStats {
+  public:
+     void record(uint32_t value) {
+         if (this->count_ == 0 || value < this->min_) {
+             this->min_ = value;
+         }
+         if (value > this->max_) {
+             this->max_ = value;
+         }
+         this->sum_ += value;
+         this->count_++;
+     }
+     void reset() {
+         this->min_ = 0;
+         this->max_ = 0;
+         this->sum_ = 0;
+         this->count_ = 0;
+     }
+     uint32_t count() const { return this->count_; }
+     uint32_t min() const { return this->min_; }
+     uint32_t max() const { return this->max_; }
+     float avg() const { return this->count_ == 0 ? 0.0f : static_cast<float>(this->sum_) / this->count_; }
+ 
+  protected:
+     uint32_t min_{0};
+     uint32_t max_{0};
+     uint64_t sum_{0};
+     uint32_t count_{0};
+ };
+ 
+ /**
+  * Log2 histogram of loop() execution times. Bucket 0 holds everything below
+  * LOOP_TIME_BASE_US, bucket n holds [BASE << (n - 1), BASE << n) and the last
+  * bucket is open ended. Percentiles are reported as the bucket's upper bound.
+  */
+ class LoopTimeHistogram {
+  public:
+     static const uint8_t BUCKETS = 16;
+     static const uint32_t LOOP_TIME_BASE_US = 32;
+ 
+     void record(uint32_t micros) {
+         uint32_t scaled = micros / LOOP_TIME_BASE_US;
+         uint8_t bucket = 0;
+         while (scaled != 0 && bucket < BUCKETS - 1) {
+             scaled >>= 1;
+             bucket++;
+         }
+         this->buckets_[bucket]++;
+         this->count_++;
+     }
+     uint32_t percentile(uint8_t percent) const {
+         const uint64_t target = (static_cast<uint64_t>(this->count_) * percent + 99) / 100;
+         uint64_t seen = 0;
+         for (uint8_t i = 0; i < BUCKETS; i++) {
+             seen += this->buckets_[i];
+             if (seen >= target) {
+                 return LOOP_TIME_BASE_US << i;
+             }
+         }
+         return LOOP_TIME_BASE_US << (BUCKETS - 1);
+     }
+     void reset() {
+         for (uint32_t &bucket : this->buckets_) {
+             bucket = 0;
+         }
+         this->count_ = 0;
+     }
+     uint32_t count() const { return this->count_; }
+ 
+  protected:
+     uint32_t buckets_[BUCKETS]{};
+     uint32_t count_{0};
+ };
+ 
+ }  // namespace hlk_ld2410s
+ }  // namespace esphome
\ No newline at end of file
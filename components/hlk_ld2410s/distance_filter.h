@@ -0,0 +1,163 @@
+/**
+ * Streaming distance filters for the HLK-LD2410S component.
+ *
+ * The filter sees every decoded frame, including the ones that publishing
+ * throttles away. All arithmetic is integer: distances are centimetres,
+ * coefficients and filter state are Q8 fixed point (256 == 1.0), so nothing
+ * here needs an FPU and memory use is fixed.
+ *
+ * Author: mouldybread
+ */
+
+ #pragma once
+ 
+ #include <cstdint>
+ 
+ namespace esphome {
+ namespace hlk_ld2410s {
+ 
+ static const uint8_t FILTER_FRACTION_BITS = 8;
+ static const int32_t FILTER_ONE = 1 << FILTER_FRACTION_BITS;
+ static const uint8_t MAX_MEDIAN_WINDOW = 9;
+ 
+ enum class DistanceFilterType : uint8_t {
+     NONE = 0,
+     MEDIAN,
+     EMA,
+     ALPHA_BETA,
+ };
+ 
+ inline const char *distance_filter_name(DistanceFilterType type) {
+     switch (type) {
+         case DistanceFilterType::MEDIAN:
+             return "median";
+         case DistanceFilterType::EMA:
+             return "ema";
+         case DistanceFilterType::ALPHA_BETA:
+             return "alpha_beta";
+         case DistanceFilterType::NONE:
+             break;
+     }
+     return "none";
+ }
+ 
+ class DistanceFilter {
+  public:
+     void set_median(uint8_t window) {
+         this->type_ = DistanceFilterType::MEDIAN;
+         this->window_ = window < 1 ? 1 : (window > MAX_MEDIAN_WINDOW ? MAX_MEDIAN_WINDOW : window);
+         this->reset();
+     }
+     // alpha is the weight of the new sample in Q8
+     void set_ema(uint16_t alpha) {
+         this->type_ = DistanceFilterType::EMA;
+         this->alpha_ = alpha;
+         this->reset();
+     }
+     // alpha corrects position and beta corrects velocity, both Q8 per sample
+     void set_alpha_beta(uint16_t alpha, uint16_t beta) {
+         this->type_ = DistanceFilterType::ALPHA_BETA;
+         this->alpha_ = alpha;
+         this->beta_ = beta;
+         this->reset();
+     }
+     void reset() {
+         this->primed_ = false;
+         this->count_ = 0;
+         this->next_ = 0;
+         this->position_ = 0;
+         this->velocity_ = 0;
+     }
+     DistanceFilterType type() const { return this->type_; }
+ 
+     // Feeds one raw distance in cm and returns the filtered distance in cm
+     uint16_t update(uint16_t distance) {
+         switch (this->type_) {
+             case DistanceFilterType::MEDIAN:
+                 return this->update_median_(distance);
+             case DistanceFilterType::EMA:
+                 return this->update_ema_(distance);
+             case DistanceFilterType::ALPHA_BETA:
+                 return this->update_alpha_beta_(distance);
+             case DistanceFilterType::NONE:
+                 break;
+         }
+         return distance;
+     }
+ 
+  protected:
+     uint16_t update_median_(uint16_t distance) {
+         this->samples_[this->next_] = distance;
+         this->next_ = (this->next_ + 1) % this->window_;
+         if (this->count_ < this->window_) {
+             this->count_++;
+         }
+ 
+         // Insertion sort of at most MAX_MEDIAN_WINDOW values
+         uint16_t sorted[MAX_MEDIAN_WINDOW];
+         for (uint8_t i = 0; i < this->count_; i++) {
+             uint16_t value = this->samples_[i];
+             uint8_t j = i;
+             while (j > 0 && sorted[j - 1] > value) {
+                 sorted[j] = sorted[j - 1];
+                 j--;
+             }
+             sorted[j] = value;
+         }
+         return sorted[this->count_ / 2];
+     }
+ 
+     uint16_t update_ema_(uint16_t distance) {
+         const int32_t sample = static_cast<int32_t>(distance) << FILTER_FRACTION_BITS;
+         if (!this->primed_) {
+             this->position_ = sample;
+             this->primed_ = true;
+         } else {
+             this->position_ += scale_(sample - this->position_, this->alpha_);
+         }
+         return this->to_distance_(this->position_);
+     }
+ 
+     uint16_t update_alpha_beta_(uint16_t distance) {
+         const int32_t sample = static_cast<int32_t>(distance) << FILTER_FRACTION_BITS;
+         if (!this->primed_) {
+             this->position_ = sample;
+             this->velocity_ = 0;
+             this->primed_ = true;
+             return distance;
+         }
+         const int32_t predicted = this->position_ + this->velocity_;
+         const int32_t residual = sample - predicted;
+         this->position_ = predicted + scale_(residual, this->alpha_);
+         this->velocity_ += scale_(residual, this->beta_);
+         return this->to_distance_(this->position_);
+     }
+ 
+     // Q8 multiply; the product of a full-range distance and 1.0 needs more than 32 bits
+     static int32_t scale_(int32_t value, uint16_t coefficient) {
+         return static_cast<int32_t>((static_cast<int64_t>(value) * coefficient) >> FILTER_FRACTION_BITS);
+     }
+ 
+     // Rounds Q8 back to whole centimetres, clamped to the frame's range
+     static uint16_t to_distance_(int32_t value) {
+         value = (value + FILTER_ONE / 2) >> FILTER_FRACTION_BITS;
+         if (value < 0) {
+             return 0;
+         }
+         return value > UINT16_MAX ? UINT16_MAX : static_cast<uint16_t>(value);
+     }
+ 
+     DistanceFilterType type_{DistanceFilterType::NONE};
+     uint8_t window_{1};
+     uint16_t alpha_{FILTER_ONE};
+     uint16_t beta_{0};
+     bool primed_{false};
+     uint16_t samples_[MAX_MEDIAN_WINDOW]{};
+     uint8_t count_{0};
+     uint8_t next_{0};
+     int32_t position_{0};
+     int32_t velocity_{0};
+ };
+ 
+ }  // namespace hlk_ld2410s
+ }  // namespace esphome
\ No newline at end of file
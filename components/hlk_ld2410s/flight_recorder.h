@@ -0,0 +1,139 @@
+/**
+ * In-RAM flight recorder for the HLK-LD2410S component.
+ *
+ * Keeps the most recent frames in a fixed byte ring so the traffic that led
+ * up to a field problem can be dumped on demand. Records are written straight
+ * from the parser buffer into the ring; nothing is staged or allocated.
+ *
+ * Record layout (all little-endian):
+ *   kind (1) | payload length (1) | timestamp ms (4) | payload
+ *
+ *   SIMPLE       state, distance (1 byte, cm)
+ *   ENGINEERING  type, state, distance (2 bytes, cm), 16 gate energies
+ *   ACK          raw configuration frame as received
+ *   REJECTED     raw bytes of a frame the parser or validation rejected
+ *   COMMAND      raw command frame as sent
+ *
+ * A dump is "HLKR", format version (1), record count (2) followed by the
+ * records from oldest to newest. tools/flight_recorder.py decodes it.
+ *
+ * Author: mouldybread
+ */
+
+ #pragma once
+ 
+ #include <cstddef>
+ #include <cstdint>
+ 
+ #include "frame_codec.h"
+ 
+ namespace esphome {
+ namespace hlk_ld2410s {
+ 
+ enum class RecordKind : uint8_t {
+     SIMPLE = 1,
+     ENGINEERING,
+     ACK,
+     REJECTED,
+     COMMAND,
+ };
+ 
+ static const uint8_t RECORD_HEADER_LENGTH = 6;
+ static const uint8_t RECORDER_FORMAT_VERSION = 1;
+ static const uint8_t RECORDER_DUMP_HEADER_LENGTH = 7;
+ 
+ template<size_t Capacity> class FlightRecorder {
+  public:
+     static_assert(Capacity >= RECORD_HEADER_LENGTH + 255, "Recorder must hold the largest record");
+ 
+     // Appends one record made of up to two byte ranges, evicting the oldest records as needed
+     void record(RecordKind kind, uint32_t timestamp, ByteView first, ByteView second = {}) {
+         size_t length = first.size + second.size;
+         if (length > UINT8_MAX) {
+             length = UINT8_MAX;
+         }
+         const size_t total = RECORD_HEADER_LENGTH + length;
+         while (Capacity - this->used_ < total) {
+             this->evict_();
+         }
+         this->put_(static_cast<uint8_t>(kind));
+         this->put_(static_cast<uint8_t>(length));
+         for (size_t i = 0; i < 4; i++) {
+             this->put_(static_cast<uint8_t>(timestamp >> (8 * i)));
+         }
+         const size_t first_length = first.size < length ? first.size : length;
+         for (size_t i = 0; i < first_length; i++) {
+             this->put_(first.data[i]);
+         }
+         for (size_t i = 0; i < length - first_length; i++) {
+             this->put_(second.data[i]);
+         }
+         this->used_ += total;
+         this->count_++;
+     }
+ 
+     size_t count() const { return this->count_; }
+     size_t size() const { return this->used_; }
+     size_t dump_size() const { return RECORDER_DUMP_HEADER_LENGTH + this->used_; }
+ 
+     // Byte index of the dump stream; the header is synthesised, records come from the ring
+     uint8_t dump_byte(size_t index) const {
+         switch (index) {
+             case 0: return 'H';
+             case 1: return 'L';
+             case 2: return 'K';
+             case 3: return 'R';
+             case 4: return RECORDER_FORMAT_VERSION;
+             case 5: return static_cast<uint8_t>(this->count_);
+             case 6: return static_cast<uint8_t>(this->count_ >> 8);
+             default: break;
+         }
+         return this->buffer_[(this->tail_ + index - RECORDER_DUMP_HEADER_LENGTH) % Capacity];
+     }
+ 
+  protected:
+     void put_(uint8_t byte) {
+         this->buffer_[this->head_] = byte;
+         this->head_ = this->head_ + 1 == Capacity ? 0 : this->head_ + 1;
+     }
+ 
+     void evict_() {
+         const size_t total = RECORD_HEADER_LENGTH + this->buffer_[(this->tail_ + 1) % Capacity];
+         this->tail_ = (this->tail_ + total) % Capacity;
+         this->used_ -= total;
+         this->count_--;
+     }
+ 
+     uint8_t buffer_[Capacity]{};
+     size_t head_{0};
+     size_t tail_{0};
+     size_t used_{0};
+     size_t count_{0};
+ };
+ 
+ // Base64 encodes length bytes of src into dst, which must hold 4 * ceil(length / 3) + 1 chars
+ inline void base64_encode_into(const uint8_t *src, size_t length, char *dst) {
+     static const char ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+     size_t i = 0;
+     for (; i + 2 < length; i += 3) {
+         *dst++ = ALPHABET[src[i] >> 2];
+         *dst++ = ALPHABET[((src[i] & 0x03) << 4) | (src[i + 1] >> 4)];
+         *dst++ = ALPHABET[((src[i + 1] & 0x0F) << 2) | (src[i + 2] >> 6)];
+         *dst++ = ALPHABET[src[i + 2] & 0x3F];
+     }
+     if (i < length) {
+         *dst++ = ALPHABET[src[i] >> 2];
+         if (i + 1 < length) {
+             *dst++ = ALPHABET[((src[i] & 0x03) << 4) | (src[i + 1] >> 4)];
+             *dst++ = ALPHABET[(src[i + 1] & 0x0F) << 2];
+         } else {
+             *dst++ = ALPHABET[(src[i] & 0x03) << 4];
+             *dst++ = '=';
+         }
+         *dst++ = '=';
+     }
+     *dst = '\0';
+ }
+ 
+ }  // namespace hlk_ld2410s
+ }  // namespace esphome
\ No newline at end of file
@@ -0,0 +1,228 @@
+/**
+ * Compile-time frame layouts and codecs for the HLK-LD2410S protocol.
+ *
+ * Every offset used to read or write a frame is defined here once and
+ * checked with static_assert. Decoders read fields in place from the parser
+ * buffer and command frames are encoded into fixed stack buffers, so neither
+ * direction touches the heap. Like frame_parser.h this only depends on the
+ * C++ standard library.
+ *
+ * Author: mouldybread
+ */
+
+ #pragma once
+ 
+ #include <array>
+ #include <cstddef>
+ #include <cstdint>
+ #include <vector>
+ 
+ namespace esphome {
+ namespace hlk_ld2410s {
+ 
+ static const uint8_t DATA_FRAME_HEADER[4] = {0xF4, 0xF3, 0xF2, 0xF1};
+ static const uint8_t DATA_FRAME_FOOTER[4] = {0xF8, 0xF7, 0xF6, 0xF5};
+ static const uint8_t CONFIG_FRAME_HEADER[4] = {0xFD, 0xFC, 0xFB, 0xFA};
+ static const uint8_t FRAME_HEADER_LENGTH = 4;
+ static const uint8_t SIMPLE_FRAME_HEAD = 0x6E;
+ static const uint8_t SIMPLE_FRAME_TAIL = 0x62;
+ static const uint8_t FRAME_BUFFER_SIZE = 128;
+ static const uint8_t MAX_GATES = 16;
+ static const uint8_t MAX_COMMAND_PAYLOAD = 48;
+ static const uint8_t MAX_PARAMETERS_PER_FRAME = 8;  // keeps the frame well inside the radar's buffer
+ 
+ enum class CommandWord : uint8_t {
+     ENABLE_CONFIGURATION = 0x04,
+     DISABLE_CONFIGURATION = 0x05,
+     READ_FIRMWARE_VERSION = 0x06,
+     WRITE_PARAMETERS = 0x07,
+     READ_PARAMETERS = 0x08,
+     SWITCH_OUTPUT_MODE = 0x0A,
+     RESTART = 0x0B,
+     RESTORE_FACTORY_SETTINGS = 0x0C,
+     READ_TRIGGER_THRESHOLD = 0x0D,
+     WRITE_TRIGGER_THRESHOLD = 0x0E,
+     READ_HOLD_THRESHOLD = 0x0F,
+     WRITE_HOLD_THRESHOLD = 0x10,
+     AUTO_THRESHOLD = 0x11,
+ };
+ 
+ enum class ResponseStatus : uint8_t {
+     SUCCESS = 0x01,
+     FAILURE = 0x02,
+     COMMAND_ERROR = 0x03,
+ };
+ 
+ // Sum of all bytes, as used by the configuration frame trailer
+ uint8_t config_checksum(const uint8_t *data, size_t length);
+ 
+ // Little-endian field of type T at a fixed byte offset
+ template<size_t Offset, typename T> struct Field {
+     static constexpr size_t OFFSET = Offset;
+     static constexpr size_t SIZE = sizeof(T);
+     static constexpr size_t END = Offset + sizeof(T);
+ 
+     static T read(const uint8_t *frame) {
+         T value = 0;
+         for (size_t i = 0; i < SIZE; i++) {
+             value |= static_cast<T>(frame[Offset + i]) << (8 * i);
+         }
+         return value;
+     }
+     static void write(uint8_t *frame, T value) {
+         for (size_t i = 0; i < SIZE; i++) {
+             frame[Offset + i] = static_cast<uint8_t>(value >> (8 * i));
+         }
+     }
+ };
+ 
+ // 0x6E, state, distance (cm), reserved, 0x62
+ struct SimpleFrame {
+     using Head = Field<0, uint8_t>;
+     using State = Field<1, uint8_t>;
+     using Distance = Field<2, uint8_t>;
+     using Tail = Field<4, uint8_t>;
+     static constexpr size_t LENGTH = Tail::END;
+     // State and distance, as kept by the flight recorder
+     static constexpr size_t SUMMARY = State::OFFSET;
+     static constexpr size_t SUMMARY_LENGTH = Distance::END - State::OFFSET;
+ };
+ static_assert(SimpleFrame::LENGTH == 5, "Simple frames are 5 bytes");
+ 
+ // Header, payload length, type, state, distance, reserved, gate energies ..., footer
+ struct EngineeringFrame {
+     using Length = Field<FRAME_HEADER_LENGTH, uint16_t>;
+     using Type = Field<Length::END, uint8_t>;
+     using State = Field<Type::END, uint8_t>;
+     using Distance = Field<State::END, uint16_t>;
+     static constexpr size_t PAYLOAD = Length::END;
+     static constexpr size_t GATE_ENERGY = Distance::END + 2;
+     static constexpr size_t PAYLOAD_LENGTH = 65;
+     static constexpr size_t FOOTER = PAYLOAD + PAYLOAD_LENGTH;
+     static constexpr size_t LENGTH = FOOTER + sizeof(DATA_FRAME_FOOTER);
+     // Type, state and distance, as kept by the flight recorder
+     static constexpr size_t SUMMARY = Type::OFFSET;
+     static constexpr size_t SUMMARY_LENGTH = Distance::END - Type::OFFSET;
+ 
+     static const uint8_t *gate_energy(const uint8_t *frame) { return frame + GATE_ENERGY; }
+ };
+ static_assert(EngineeringFrame::State::OFFSET == 7, "Target state follows the frame type");
+ static_assert(EngineeringFrame::GATE_ENERGY == 12, "Gate energies start after the reserved bytes");
+ static_assert(EngineeringFrame::GATE_ENERGY + MAX_GATES <= EngineeringFrame::FOOTER, "Gate energies overlap the footer");
+ static_assert(EngineeringFrame::LENGTH == 75, "Engineering frames are 75 bytes");
+ static_assert(EngineeringFrame::LENGTH <= FRAME_BUFFER_SIZE, "Engineering frame does not fit the parser buffer");
+ 
+ // ACK data of READ_FIRMWARE_VERSION: firmware type, minor, major, build
+ struct FirmwareVersion {
+     using Type = Field<0, uint16_t>;
+     using Minor = Field<Type::END, uint8_t>;
+     using Major = Field<Minor::END, uint8_t>;
+     using Build = Field<Major::END, uint32_t>;
+     static constexpr size_t LENGTH = Build::END;
+ };
+ static_assert(FirmwareVersion::LENGTH == 8, "Firmware version responses carry 8 bytes");
+ 
+ /**
+  * Data frame layout of one firmware family. Known families get an exact
+  * length check, so a frame is accepted or rejected with one compare; the
+  * tolerant variant covers firmware that was not probed or is not known
+  * yet and decodes any engineering payload holding the fixed fields.
+  * Parameter ids are shared by every known family and live in ParameterId.
+  */
+ struct ProtocolVariant {
+     const char *name;
+     uint8_t min_major;
+     uint8_t max_major;
+     uint8_t engineering_payload_length;  // 0 accepts any length
+ };
+ 
+ // Bytes of an engineering payload in front of the gate energies
+ static const uint8_t ENGINEERING_FIXED_LENGTH = EngineeringFrame::GATE_ENERGY - EngineeringFrame::PAYLOAD;
+ 
+ static const ProtocolVariant TOLERANT_VARIANT = {"tolerant", 0, 0, 0};
+ static const ProtocolVariant PROTOCOL_VARIANTS[] = {
+     {"v1", 1, 1, EngineeringFrame::PAYLOAD_LENGTH},
+ };
+ 
+ // Variant for a firmware major version, TOLERANT_VARIANT if none matches
+ const ProtocolVariant &select_protocol_variant(uint8_t major);
+ 
+ // Number of gate energies an engineering payload of this length carries under variant, 0 if it must be rejected
+ uint8_t engineering_gate_count(const ProtocolVariant &variant, size_t payload_length);
+ 
+ /**
+  * Header, body length, body, checksum. Command bodies are the command word
+  * followed by its payload; ACK bodies are the status, the echoed command
+  * word and any response data.
+  */
+ struct ConfigFrame {
+     using Length = Field<FRAME_HEADER_LENGTH, uint16_t>;
+     static constexpr size_t BODY = Length::END;
+     static constexpr size_t OVERHEAD = BODY + 1;
+ 
+     using Command = Field<BODY, uint8_t>;
+     static constexpr size_t COMMAND_PAYLOAD = Command::END;
+ 
+     using Status = Field<BODY, uint8_t>;
+     using AckCommand = Field<Status::END, uint8_t>;
+     static constexpr size_t ACK_DATA = AckCommand::END;
+     static constexpr size_t ACK_MIN_LENGTH = ACK_DATA + 1;
+ };
+ static_assert(ConfigFrame::ACK_MIN_LENGTH == 9, "ACKs carry at least status and command word");
+ 
+ // One (parameter id, value) pair inside a WRITE_PARAMETERS payload
+ struct ParameterEntryLayout {
+     using Id = Field<0, uint16_t>;
+     using Value = Field<Id::END, uint32_t>;
+     static constexpr size_t SIZE = Value::END;
+ };
+ static_assert(MAX_PARAMETERS_PER_FRAME * ParameterEntryLayout::SIZE <= MAX_COMMAND_PAYLOAD,
+               "A full parameter batch must fit one command payload");
+ static_assert(MAX_GATES <= MAX_COMMAND_PAYLOAD, "A threshold table must fit one command payload");
+ 
+ // Non-owning view of the bytes passed to a command
+ struct ByteView {
+     ByteView() = default;
+     ByteView(const uint8_t *data, size_t size) : data(data), size(size) {}
+     ByteView(const std::vector<uint8_t> &bytes) : data(bytes.data()), size(bytes.size()) {}
+     template<size_t N> ByteView(const std::array<uint8_t, N> &bytes) : data(bytes.data()), size(N) {}
+ 
+     const uint8_t *data{nullptr};
+     size_t size{0};
+ };
+ 
+ // Command frame encoded into a fixed buffer sized for PayloadCapacity bytes
+ template<size_t PayloadCapacity> class CommandFrame {
+  public:
+     static constexpr size_t CAPACITY = ConfigFrame::COMMAND_PAYLOAD + PayloadCapacity + 1;
+ 
+     // Returns false if the payload does not fit
+     bool encode(CommandWord cmd, ByteView payload) {
+         if (payload.size > PayloadCapacity) {
+             this->size_ = 0;
+             return false;
+         }
+         for (size_t i = 0; i < FRAME_HEADER_LENGTH; i++) {
+             this->buffer_[i] = CONFIG_FRAME_HEADER[i];
+         }
+         ConfigFrame::Length::write(this->buffer_.data(), static_cast<uint16_t>(payload.size + ConfigFrame::Command::SIZE));
+         ConfigFrame::Command::write(this->buffer_.data(), static_cast<uint8_t>(cmd));
+         for (size_t i = 0; i < payload.size; i++) {
+             this->buffer_[ConfigFrame::COMMAND_PAYLOAD + i] = payload.data[i];
+         }
+         this->size_ = ConfigFrame::COMMAND_PAYLOAD + payload.size;
+         this->buffer_[this->size_] = config_checksum(this->buffer_.data(), this->size_);
+         this->size_++;
+         return true;
+     }
+ 
+     const uint8_t *data() const { return this->buffer_.data(); }
+     size_t size() const { return this->size_; }
+ 
+  protected:
+     std::array<uint8_t, CAPACITY> buffer_{};
+     size_t size_{0};
+ };
+ 
+ }  // namespace hlk_ld2410s
+ }  // namespace esphome
\ No newline at end of file
@@ -0,0 +1,188 @@
+/**
+ * Implementation of the HLK-LD2410S incremental frame parser.
+ *
+ * Author: mouldybread
+ */
+
+ #include "frame_parser.h"
+ 
+ namespace esphome {
+ namespace hlk_ld2410s {
+ 
+ uint8_t config_checksum(const uint8_t *data, size_t length) {
+     uint8_t sum = 0;
+     for (size_t i = 0; i < length; i++) {
+         sum += data[i];
+     }
+     return sum;
+ }
+ 
+ const ProtocolVariant &select_protocol_variant(uint8_t major) {
+     for (const ProtocolVariant &variant : PROTOCOL_VARIANTS) {
+         if (major >= variant.min_major && major <= variant.max_major) {
+             return variant;
+         }
+     }
+     return TOLERANT_VARIANT;
+ }
+ 
+ uint8_t engineering_gate_count(const ProtocolVariant &variant, size_t payload_length) {
+     if (variant.engineering_payload_length != 0) {
+         return payload_length == variant.engineering_payload_length ? MAX_GATES : 0;
+     }
+     if (payload_length <= ENGINEERING_FIXED_LENGTH) {
+         return 0;
+     }
+     const size_t gates = payload_length - ENGINEERING_FIXED_LENGTH;
+     return gates < MAX_GATES ? static_cast<uint8_t>(gates) : MAX_GATES;
+ }
+ 
+ ConfigFrameError check_config_frame(const uint8_t *data, size_t length) {
+     if (length < ConfigFrame::ACK_MIN_LENGTH) {
+         return ConfigFrameError::TOO_SHORT;
+     }
+     for (size_t i = 0; i < FRAME_HEADER_LENGTH; i++) {
+         if (data[i] != CONFIG_FRAME_HEADER[i]) {
+             return ConfigFrameError::BAD_HEADER;
+         }
+     }
+     if (ConfigFrame::Length::read(data) + ConfigFrame::OVERHEAD != length) {
+         return ConfigFrameError::BAD_LENGTH;
+     }
+     if (data[length - 1] != config_checksum(data, length - 1)) {
+         return ConfigFrameError::BAD_CHECKSUM;
+     }
+     return ConfigFrameError::NONE;
+ }
+ 
+ void FrameParser::reset() {
+     this->state_ = State::HUNT;
+     this->length_ = 0;
+     this->payload_end_ = 0;
+ }
+ 
+ FrameType FrameParser::start_(uint8_t byte) {
+     // Whatever was buffered did not make it into a frame
+     this->stats_.discarded_bytes += this->length_;
+     this->reset();
+     if (byte == SIMPLE_FRAME_HEAD) {
+         this->buffer_[this->length_++] = byte;
+         this->state_ = State::SIMPLE_BODY;
+     } else if (byte == DATA_FRAME_HEADER[0]) {
+         this->buffer_[this->length_++] = byte;
+         this->header_ = DATA_FRAME_HEADER;
+         this->kind_ = FrameType::ENGINEERING;
+         this->state_ = State::HEADER;
+     } else if (byte == CONFIG_FRAME_HEADER[0]) {
+         this->buffer_[this->length_++] = byte;
+         this->header_ = CONFIG_FRAME_HEADER;
+         this->kind_ = FrameType::CONFIG;
+         this->state_ = State::HEADER;
+     } else {
+         this->stats_.discarded_bytes++;
+     }
+     return FrameType::NONE;
+ }
+ 
+ FrameType FrameParser::resync_simple_() {
+     // Not a frame after all; a real header may hide in the bytes after the
+     // false start. At most four bytes are replayed, so this stays O(1).
+     uint8_t pending[SimpleFrame::LENGTH - 1];
+     for (size_t i = 0; i < sizeof(pending); i++) {
+         pending[i] = this->buffer_[i + 1];
+     }
+     this->stats_.discarded_bytes++;
+     this->reset();
+     FrameType frame = FrameType::NONE;
+     for (uint8_t byte : pending) {
+         frame = this->feed(byte);
+     }
+     return frame;
+ }
+ 
+ FrameType FrameParser::feed(uint8_t byte) {
+     switch (this->state_) {
+         case State::HUNT:
+             // The previous frame, if any, has been consumed by now
+             this->length_ = 0;
+             return this->start_(byte);
+ 
+         case State::SIMPLE_BODY:
+             this->buffer_[this->length_++] = byte;
+             if (this->length_ < SimpleFrame::LENGTH) {
+                 return FrameType::NONE;
+             }
+             this->state_ = State::HUNT;
+             if (byte == SIMPLE_FRAME_TAIL) {
+                 return FrameType::SIMPLE;
+             }
+             return this->resync_simple_();
+ 
+         case State::HEADER:
+             if (byte != this->header_[this->length_]) {
+                 return this->start_(byte);
+             }
+             this->buffer_[this->length_++] = byte;
+             if (this->length_ == FRAME_HEADER_LENGTH) {
+                 this->state_ = State::LENGTH;
+             }
+             return FrameType::NONE;
+ 
+         case State::LENGTH: {
+             this->buffer_[this->length_++] = byte;
+             // Engineering and configuration frames share the length field layout
+             if (this->length_ < EngineeringFrame::Length::END) {
+                 return FrameType::NONE;
+             }
+             const size_t payload_length = EngineeringFrame::Length::read(this->buffer_);
+             const size_t trailer_length = this->kind_ == FrameType::ENGINEERING ? sizeof(DATA_FRAME_FOOTER) : 1;
+             this->payload_end_ = this->length_ + payload_length;
+             if (payload_length == 0 || this->payload_end_ + trailer_length > FRAME_BUFFER_SIZE) {
+                 this->stats_.overflows++;
+                 this->stats_.discarded_bytes += this->length_;
+                 // Keep header and length readable until the next byte
+                 this->state_ = State::HUNT;
+                 return FrameType::INVALID;
+             }
+             this->state_ = State::PAYLOAD;
+             return FrameType::NONE;
+         }
+ 
+         case State::PAYLOAD:
+             this->buffer_[this->length_++] = byte;
+             if (this->length_ == this->payload_end_) {
+                 this->state_ = this->kind_ == FrameType::ENGINEERING ? State::FOOTER : State::CHECKSUM;
+             }
+             return FrameType::NONE;
+ 
+         case State::FOOTER:
+             if (byte != DATA_FRAME_FOOTER[this->length_ - this->payload_end_]) {
+                 this->stats_.bad_footers++;
+                 // Leave the rejected frame readable; the byte is handled on the next call
+                 this->pending_byte_ = byte;
+                 this->state_ = State::REJECTED;
+                 return FrameType::INVALID;
+             }
+             this->buffer_[this->length_++] = byte;
+             if (this->length_ < this->payload_end_ + sizeof(DATA_FRAME_FOOTER)) {
+                 return FrameType::NONE;
+             }
+             this->state_ = State::HUNT;
+             return FrameType::ENGINEERING;
+ 
+         case State::REJECTED:
+             // start_() never completes a frame, so only the new byte can
+             this->start_(this->pending_byte_);
+             return this->feed(byte);
+ 
+         case State::CHECKSUM:
+             // The checksum itself is verified by the consumer
+             this->buffer_[this->length_++] = byte;
+             this->state_ = State::HUNT;
+             return FrameType::CONFIG;
+     }
+     return FrameType::NONE;
+ }
+ 
+ }  // namespace hlk_ld2410s
+ }  // namespace esphome
\ No newline at end of file
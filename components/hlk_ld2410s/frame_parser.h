@@ -0,0 +1,92 @@
+/**
+ * Incremental frame parser for the HLK-LD2410S data stream.
+ *
+ * This file and frame_parser.cpp only depend on the C++ standard library so
+ * the receive path can be compiled and profiled on a host machine.
+ *
+ * Author: mouldybread
+ */
+
+ #pragma once
+ 
+ #include <cstddef>
+ #include <cstdint>
+ 
+ #include "frame_codec.h"
+ 
+ namespace esphome {
+ namespace hlk_ld2410s {
+ 
+ enum class FrameType : uint8_t {
+     NONE = 0,
+     SIMPLE,
+     ENGINEERING,
+     CONFIG,
+     INVALID,
+ };
+ 
+ enum class ConfigFrameError : uint8_t {
+     NONE = 0,
+     TOO_SHORT,
+     BAD_HEADER,
+     BAD_LENGTH,
+     BAD_CHECKSUM,
+ };
+ 
+ // Checks header, length field and checksum of a complete configuration frame
+ ConfigFrameError check_config_frame(const uint8_t *data, size_t length);
+ 
+ // Link health counters maintained by the parser; cumulative since boot
+ struct ParserStats {
+     uint32_t discarded_bytes{0};
+     uint32_t bad_footers{0};
+     uint32_t overflows{0};
+ };
+ 
+ /**
+  * Byte-at-a-time state machine that recognises simple (0x6E ... 0x62),
+  * engineering (F4F3F2F1 ... F8F7F6F5) and configuration ACK (FDFCFBFA ...
+  * checksum) frames in the same pass. Each byte is handled in constant time
+  * and the frame is assembled in place, so nothing is allocated or shifted
+  * after construction.
+  */
+ class FrameParser {
+  public:
+     // Feed one byte. Returns the type of frame completed by this byte, if any.
+     // For INVALID, data()/size() hold the rejected bytes until the next call.
+     FrameType feed(uint8_t byte);
+     void reset();
+ 
+     // True between frames, i.e. the next byte may start a new one
+     bool idle() const { return this->state_ == State::HUNT || this->state_ == State::REJECTED; }
+     const uint8_t *data() const { return this->buffer_; }
+     size_t size() const { return this->length_; }
+     const ParserStats &stats() const { return this->stats_; }
+ 
+  protected:
+     enum class State : uint8_t {
+         HUNT,
+         SIMPLE_BODY,
+         HEADER,
+         LENGTH,
+         PAYLOAD,
+         FOOTER,
+         CHECKSUM,
+         REJECTED,
+     };
+ 
+     FrameType start_(uint8_t byte);
+     FrameType resync_simple_();
+ 
+     ParserStats stats_;
+     State state_{State::HUNT};
+     FrameType kind_{FrameType::NONE};
+     const uint8_t *header_{DATA_FRAME_HEADER};
+     uint8_t buffer_[FRAME_BUFFER_SIZE]{};
+     size_t length_{0};
+     size_t payload_end_{0};
+     uint8_t pending_byte_{0};
+ };
+ 
+ }  // namespace hlk_ld2410s
+ }  // namespace esphome
\ No newline at end of file
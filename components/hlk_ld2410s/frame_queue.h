@@ -0,0 +1,77 @@
+/**
+ * Lock-free hand-off of decoded frames between a receive task and loop().
+ *
+ * Like frame_parser.h this only depends on the C++ standard library, so the
+ * queue can be exercised on a host with std::thread as the producer.
+ *
+ * Author: mouldybread
+ */
+
+ #pragma once
+ 
+ #include <array>
+ #include <atomic>
+ #include <cstddef>
+ #include <cstdint>
+ 
+ #include "frame_parser.h"
+ 
+ namespace esphome {
+ namespace hlk_ld2410s {
+ 
+ static const uint8_t RX_QUEUE_DEPTH = 8;
+ 
+ // A complete frame as it left the parser
+ struct ReceivedFrame {
+     FrameType type{FrameType::NONE};
+     uint8_t length{0};
+     uint32_t received_at{0};  // micros() of the read that delivered the first byte
+     std::array<uint8_t, FRAME_BUFFER_SIZE> data;
+ };
+ 
+ /**
+  * Bounded single-producer/single-consumer ring. push() may only be called
+  * from one thread and pop() from one other thread; neither blocks. One slot
+  * stays empty to tell a full ring from an empty one.
+  */
+ template<typename T, size_t Capacity> class SpscQueue {
+  public:
+     // Producer side. Returns false, leaving the queue untouched, when full.
+     bool push(const T &item) {
+         const size_t head = this->head_.load(std::memory_order_relaxed);
+         const size_t next = (head + 1) % SLOTS;
+         if (next == this->tail_.load(std::memory_order_acquire)) {
+             return false;
+         }
+         this->slots_[head] = item;
+         this->head_.store(next, std::memory_order_release);
+         return true;
+     }
+ 
+     // Consumer side. Returns false when there is nothing to take.
+     bool pop(T &item) {
+         const size_t tail = this->tail_.load(std::memory_order_relaxed);
+         if (tail == this->head_.load(std::memory_order_acquire)) {
+             return false;
+         }
+         item = this->slots_[tail];
+         this->tail_.store((tail + 1) % SLOTS, std::memory_order_release);
+         return true;
+     }
+ 
+     bool empty() const {
+         return this->head_.load(std::memory_order_acquire) == this->tail_.load(std::memory_order_acquire);
+     }
+ 
+  protected:
+     static constexpr size_t SLOTS = Capacity + 1;
+ 
+     std::array<T, SLOTS> slots_{};
+     std::atomic<size_t> head_{0};
+     std::atomic<size_t> tail_{0};
+ };
+ 
+ using FrameQueue = SpscQueue<ReceivedFrame, RX_QUEUE_DEPTH>;
+ 
+ }  // namespace hlk_ld2410s
+ }  // namespace esphome
\ No newline at end of file
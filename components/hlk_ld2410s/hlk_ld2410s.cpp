@@ -12,468 +12,1483 @@
  namespace esphome {
  namespace hlk_ld2410s {
  
+ const char *parameter_name(ParameterId id) {
+     switch (id) {
+         case ParameterId::STATUS_REPORT_FREQUENCY:
+             return "status report frequency";
+         case ParameterId::FARTHEST_GATE:
+             return "farthest gate";
+         case ParameterId::UNMANNED_DELAY:
+             return "unmanned delay";
+         case ParameterId::NEAREST_GATE:
+             return "nearest gate";
+         case ParameterId::RESPONSE_SPEED:
+             return "response speed";
+         case ParameterId::DISTANCE_REPORT_FREQUENCY:
+             return "distance report frequency";
+     }
+     return "unknown parameter";
+ }
+ 
+ uint32_t fnv1a_hash(const uint8_t *data, size_t length, uint32_t hash) {
+     for (size_t i = 0; i < length; i++) {
+         hash ^= data[i];
+         hash *= 16777619UL;
+     }
+     return hash;
+ }
+ 
+ uint32_t report_frequency_value(float frequency) { return static_cast<uint32_t>(lroundf(frequency * 10)); }
+ 
+ bool ParameterSet::add(ParameterId id, uint32_t value) {
+     for (size_t i = 0; i < this->count_; i++) {
+         if (this->entries_[i].id == id) {
+             this->entries_[i].value = value;
+             return true;
+         }
+     }
+     if (this->count_ >= MAX_PARAMETERS) {
+         return false;
+     }
+     this->entries_[this->count_++] = {id, value};
+     return true;
+ }
+ 
+ size_t ParameterSet::encode(size_t offset, uint8_t *payload) const {
+     size_t count = 0;
+     for (size_t i = offset; i < this->count_ && count < MAX_PARAMETERS_PER_FRAME; i++, count++) {
+         uint8_t *entry = payload + count * ParameterEntryLayout::SIZE;
+         ParameterEntryLayout::Id::write(entry, static_cast<uint16_t>(this->entries_[i].id));
+         ParameterEntryLayout::Value::write(entry, this->entries_[i].value);
+     }
+     return count;
+ }
+ 
+ int DeviceMirror::index_(ParameterId id) {
+     for (uint8_t i = 0; i < MIRRORED_PARAMETER_COUNT; i++) {
+         if (MIRRORED_PARAMETERS[i] == id) {
+             return i;
+         }
+     }
+     return -1;
+ }
+ 
+ void DeviceMirror::clear() {
+     this->known_ = 0;
+ #ifdef HLK_LD2410S_THRESHOLDS
+     this->has_trigger_thresholds_ = false;
+     this->has_hold_thresholds_ = false;
+ #endif
+ }
+ 
+ void DeviceMirror::set(ParameterId id, uint32_t value) {
+     const int index = index_(id);
+     if (index >= 0) {
+         this->values_[index] = value;
+         this->known_ |= 1 << index;
+     }
+ }
+ 
+ bool DeviceMirror::has(ParameterId id) const {
+     const int index = index_(id);
+     return index >= 0 && (this->known_ & (1 << index)) != 0;
+ }
+ 
+ uint32_t DeviceMirror::get(ParameterId id) const {
+     const int index = index_(id);
+     return index >= 0 ? this->values_[index] : 0;
+ }
+ 
+ #ifdef HLK_LD2410S_THRESHOLDS
+ void DeviceMirror::set_trigger_thresholds(const uint8_t *thresholds) {
+     std::copy(thresholds, thresholds + MAX_GATES, this->trigger_thresholds_.begin());
+     this->has_trigger_thresholds_ = true;
+ }
+ 
+ void DeviceMirror::set_hold_thresholds(const uint8_t *thresholds) {
+     std::copy(thresholds, thresholds + MAX_GATES, this->hold_thresholds_.begin());
+     this->has_hold_thresholds_ = true;
+ }
+ #endif
+ 
+ bool PublishGate::should_publish(float value, uint32_t now, uint32_t interval, float deadband, uint32_t max_silence) {
+     if (this->published) {
+         if (now - this->last_publish < interval) {
+             return false;
+         }
+         const float delta = std::fabs(value - this->last_value);
+         const bool changed = deadband > 0.0f ? delta >= deadband : delta > 0.0f;
+         const bool silent_too_long = max_silence > 0 && now - this->last_publish >= max_silence;
+         if (!changed && !silent_too_long) {
+             return false;
+         }
+     }
+     this->mark_published(value, now);
+     return true;
+ }
+ 
  void HLKLD2410SComponent::setup() {
      ESP_LOGCONFIG(TAG, "Setting up HLK-LD2410S...");
      this->reset_input_buffer_();
-     if (!this->enable_configuration_()) {
-         ESP_LOGE(TAG, "%s: Failed to enable configuration mode", ERROR_CONFIGURATION);
+ #ifdef HLK_LD2410S_RX_TASK
+     if (xTaskCreate(HLKLD2410SComponent::rx_task_, "hlk_ld2410s_rx", RX_TASK_STACK_SIZE, this, RX_TASK_PRIORITY,
+                     &this->rx_task_handle_) != pdPASS) {
+         this->rx_task_handle_ = nullptr;
+         ESP_LOGE(TAG, "Failed to start receive task, receiving from loop() instead");
+     }
+ #endif
+     // In flash, not RTC memory: the record has to survive a power cycle to save the next boot's writes
+     this->config_pref_ = global_preferences->make_preference<StoredConfig>(this->preference_key_, true);
+ #ifdef HLK_LD2410S_ADAPTIVE_REPORT
+     // The frequencies are not configurable alongside adaptive_report. Status reports always run at the
+     // active frequency, and distance reports start at it until the room is empty
+     if (this->adaptive_report_.enabled()) {
+         this->status_report_frequency_ = this->adaptive_report_.active_frequency();
+         this->distance_report_frequency_ = this->adaptive_report_.active_frequency();
+         this->adaptive_report_.start(millis());
+     }
+ #endif
+     this->publish_controls_();
+ 
+     // The whole configuration session runs from loop() as a command pipeline, see handle_result_()
+     this->enable_configuration_(CommandStep::BOOT_CONFIG_MODE);
+ }
+ 
+ void HLKLD2410SComponent::configure_(const uint8_t *firmware, size_t length) {
+     // An unknown firmware version never matches, so the configuration is always written
+     this->boot_firmware_hash_ = length > 0 ? fnv1a_hash(firmware, length) : 0;
+     this->boot_config_hash_ = this->config_hash_();
+     StoredConfig stored{};
+     this->boot_config_stored_ = !this->force_reconfigure_ && this->boot_firmware_hash_ != 0 &&
+                                 this->config_pref_.load(&stored) && stored.config_hash == this->boot_config_hash_ &&
+                                 stored.firmware_hash == this->boot_firmware_hash_;
+ 
+     // The read-back also catches a radar reconfigured behind our back, e.g. with the vendor app
+     this->read_device_state_(CommandStep::BOOT_STATE_READ);
+ }
+ 
+ void HLKLD2410SComponent::boot_state_read_() {
+     if (this->boot_config_stored_ && !this->device_differs_()) {
+         ESP_LOGI(TAG, "Radar already holds this configuration, skipping");
+         this->disable_configuration_();
          return;
      }
      this->apply_cached_config_();
-     if (!this->disable_configuration_()) {
-         ESP_LOGE(TAG, "%s: Failed to disable configuration mode", ERROR_CONFIGURATION);
+     this->disable_configuration_(CommandStep::BOOT_CONFIGURED);
+ }
+ 
+ void HLKLD2410SComponent::read_device_state_(CommandStep then) {
+     // Commands run in order, so the last read sees every answer
+     this->device_mirror_.clear();
+     uint8_t payload[MIRRORED_PARAMETER_COUNT * sizeof(uint16_t)];
+     for (uint8_t i = 0; i < MIRRORED_PARAMETER_COUNT; i++) {
+         Field<0, uint16_t>::write(payload + i * sizeof(uint16_t), static_cast<uint16_t>(MIRRORED_PARAMETERS[i]));
      }
+ #ifdef HLK_LD2410S_THRESHOLDS
+     this->queue_command_(CommandWord::READ_PARAMETERS, ByteView(payload, sizeof(payload)), CommandStep::PARAMETERS_READ,
+                          static_cast<uint32_t>(CommandStep::NONE));
+     this->queue_command_(CommandWord::READ_TRIGGER_THRESHOLD, {}, CommandStep::TRIGGER_THRESHOLDS_READ);
+     this->queue_command_(CommandWord::READ_HOLD_THRESHOLD, {}, CommandStep::HOLD_THRESHOLDS_READ,
+                          static_cast<uint32_t>(then));
+ #else
+     this->queue_command_(CommandWord::READ_PARAMETERS, ByteView(payload, sizeof(payload)), CommandStep::PARAMETERS_READ,
+                          static_cast<uint32_t>(then));
+ #endif
  }
  
- void HLKLD2410SComponent::loop() {
-     const uint32_t now = millis();
-     if (now - this->last_update_ < this->throttle_) {
+ bool HLKLD2410SComponent::device_differs_() const {
+     // A local set: pending_parameters_ may hold a runtime change queued while booting
+     bool differs = false;
+     ParameterSet configured;
+     this->stage_parameters_(configured);
+     for (size_t i = 0; i < configured.size(); i++) {
+         const ParameterEntry &entry = configured[i];
+         if (this->device_mirror_.differs(entry.id, entry.value)) {
+             ESP_LOGW(TAG, "Radar %s is %u instead of %u", parameter_name(entry.id), this->device_mirror_.get(entry.id),
+                      entry.value);
+             differs = true;
+         }
+     }
+ #ifdef HLK_LD2410S_THRESHOLDS
+     if (this->has_trigger_thresholds_ && this->has_hold_thresholds_ &&
+         ((this->device_mirror_.has_trigger_thresholds() &&
+           this->device_mirror_.trigger_thresholds() != this->trigger_thresholds_) ||
+          (this->device_mirror_.has_hold_thresholds() && this->device_mirror_.hold_thresholds() != this->hold_thresholds_))) {
+         ESP_LOGW(TAG, "Radar thresholds differ from the configuration");
+         differs = true;
+     }
+ #endif
+     return differs;
+ }
+ 
+ void HLKLD2410SComponent::apply_firmware_version_(const uint8_t *firmware, size_t length) {
+     if (length < FirmwareVersion::LENGTH) {
+         ESP_LOGW(TAG, "%s: Unknown firmware version, decoding with the %s layout", ERROR_VALIDATION,
+                  this->protocol_variant_->name);
          return;
      }
-     this->last_update_ = now;
+     // Printed the way the vendor tool shows it, e.g. 2.04.23061514
+     char version[24];
+     snprintf(version, sizeof(version), "%u.%02X.%08X", FirmwareVersion::Major::read(firmware),
+              FirmwareVersion::Minor::read(firmware), static_cast<unsigned>(FirmwareVersion::Build::read(firmware)));
+     this->firmware_version_ = version;
+     this->protocol_variant_ = &select_protocol_variant(FirmwareVersion::Major::read(firmware));
+     ESP_LOGI(TAG, "Firmware %s, using the %s frame layout", version, this->protocol_variant_->name);
+ #ifdef HLK_LD2410S_FIRMWARE_SENSOR
+     if (this->firmware_version_sensor_ != nullptr) {
+         this->firmware_version_sensor_->publish_state(this->firmware_version_);
+     }
+ #endif
+ }
  
-     while (this->available()) {
-         this->read_data_();
+ uint32_t HLKLD2410SComponent::config_hash_() const {
+     // Everything apply_cached_config_() writes, in the encoding sent to the radar
+     const uint8_t values[] = {
+         static_cast<uint8_t>(this->output_mode_),
+         this->response_speed_,
+         this->unmanned_delay_,
+         static_cast<uint8_t>(report_frequency_value(this->status_report_frequency_)),
+         static_cast<uint8_t>(report_frequency_value(this->distance_report_frequency_)),
+         this->farthest_gate_,
+         this->nearest_gate_,
+         this->trigger_factor_,
+         this->hold_factor_,
+         this->scan_time_,
+     };
+     uint32_t hash = fnv1a_hash(values, sizeof(values));
+ #ifdef HLK_LD2410S_THRESHOLDS
+     // Tables that are not configured are not written, so they do not count
+     if (this->has_trigger_thresholds_) {
+         hash = fnv1a_hash(this->trigger_thresholds_.data(), this->trigger_thresholds_.size(), hash);
+     }
+     if (this->has_hold_thresholds_) {
+         hash = fnv1a_hash(this->hold_thresholds_.data(), this->hold_thresholds_.size(), hash);
      }
+ #endif
+     return hash;
+ }
+ 
+ void HLKLD2410SComponent::loop() {
+     const uint32_t loop_start = micros();
+ 
+ #ifdef HLK_LD2410S_RX_TASK
+     // Frames were decoded by the receive task; without it, decode inline and take the same route
+     if (this->rx_task_handle_ == nullptr) {
+         this->receive_(MAX_BYTES_PER_LOOP, this->loop_budget_);
+     }
+     // At least one frame per loop even when receiving used up the budget, so the queue always drains
+     ReceivedFrame frame;
+     while (this->rx_queue_.pop(frame)) {
+         this->dispatch_frame_(frame.type, frame.data.data(), frame.length, frame.received_at);
+         if (!this->rx_queue_.empty() && micros() - loop_start >= this->loop_budget_) {
+             this->link_stats_.budget_exhausted++;
+             break;
+         }
+     }
+ #else
+     // Drain the UART so the FIFO never overflows; only publishing is throttled
+     this->receive_(MAX_BYTES_PER_LOOP, this->loop_budget_);
+ #endif
+     this->process_command_queue_();
+     const uint32_t now = millis();
+ #ifdef HLK_LD2410S_CALIBRATION
+     if (this->calibration_.finished(now)) {
+         this->finish_calibration_();
+     }
+ #endif
+ #ifdef HLK_LD2410S_ADAPTIVE_REPORT
+     this->adapt_report_frequency_(now);
+ #endif
+     this->run_config_session_(now);
+     this->publish_state_(now);
+     this->publish_diagnostics_(now);
+     this->tracer_.report(now, TAG);
+ 
+     this->loop_time_.record(micros() - loop_start);
  }
  
  void HLKLD2410SComponent::dump_config() {
      ESP_LOGCONFIG(TAG, "HLK-LD2410S:");
      ESP_LOGCONFIG(TAG, "  Update Interval: %ums", this->throttle_);
+     ESP_LOGCONFIG(TAG, "  Distance Deadband: %.2fm", this->distance_deadband_);
+     ESP_LOGCONFIG(TAG, "  Max Silence: %ums", this->max_silence_);
+     ESP_LOGCONFIG(TAG, "  Distance Filter: %s", distance_filter_name(this->distance_filter_.type()));
+ #ifdef HLK_LD2410S_ENERGY_WINDOW
+     ESP_LOGCONFIG(TAG, "  Gate Energy Window: %ums", this->gate_energy_window_);
+ #endif
+ #ifdef HLK_LD2410S_ZONES
+     ESP_LOGCONFIG(TAG, "  Zones: %u", this->zone_count_);
+     for (uint8_t i = 0; i < this->zone_count_; i++) {
+         LOG_BINARY_SENSOR("    ", "Zone Occupancy", this->zone_occupancy_sensors_[i]);
+         LOG_SENSOR("    ", "Zone Energy", this->zone_energy_sensors_[i]);
+     }
+ #endif
+     ESP_LOGCONFIG(TAG, "  Trace Level: %d", HLK_LD2410S_TRACE_LEVEL);
+     ESP_LOGCONFIG(TAG, "  Diagnostics Interval: %ums", this->diagnostics_interval_);
+     ESP_LOGCONFIG(TAG, "  Loop Budget: %uus", this->loop_budget_);
+     for (sensor::Sensor *diagnostic_sensor : this->diagnostic_sensors_) {
+         LOG_SENSOR("  ", "Diagnostic", diagnostic_sensor);
+     }
      LOG_SENSOR("  ", "Distance", this->distance_sensor_);
      LOG_BINARY_SENSOR("  ", "Presence", this->presence_sensor_);
      LOG_BINARY_SENSOR("  ", "Config Mode", this->config_mode_sensor_);
+ #ifdef HLK_LD2410S_FIRMWARE_SENSOR
+     LOG_TEXT_SENSOR("  ", "Firmware Version", this->firmware_version_sensor_);
+ #endif
+     ESP_LOGCONFIG(TAG, "  Firmware: %s (%s layout)", this->firmware_version_.empty() ? "unknown" : this->firmware_version_.c_str(),
+                   this->protocol_variant_->name);
+     ESP_LOGCONFIG(TAG, "  Force Reconfigure: %s", this->force_reconfigure_ ? "Yes" : "No");
      ESP_LOGCONFIG(TAG, "  Output Mode: %s", this->output_mode_ ? "Engineering" : "Simple");
      ESP_LOGCONFIG(TAG, "  Response Speed: %d", this->response_speed_);
      ESP_LOGCONFIG(TAG, "  Unmanned Delay: %d", this->unmanned_delay_);
      ESP_LOGCONFIG(TAG, "  Status Report Frequency: %.1f", this->status_report_frequency_);
      ESP_LOGCONFIG(TAG, "  Distance Report Frequency: %.1f", this->distance_report_frequency_);
+     for (ParameterId id : MIRRORED_PARAMETERS) {
+         if (this->device_mirror_.has(id)) {
+             ESP_LOGCONFIG(TAG, "  Radar reports %s: %u", parameter_name(id), this->device_mirror_.get(id));
+         }
+     }
+ #ifdef HLK_LD2410S_ADAPTIVE_REPORT
+     if (this->adaptive_report_.enabled()) {
+         ESP_LOGCONFIG(TAG, "  Adaptive Report: distance at %.1f Hz idle after %ums, %.1f Hz on presence",
+                       this->adaptive_report_.idle_frequency(), this->adaptive_report_.idle_after(),
+                       this->adaptive_report_.active_frequency());
+     }
+ #endif
      ESP_LOGCONFIG(TAG, "  Farthest Gate: %d", this->farthest_gate_);
      ESP_LOGCONFIG(TAG, "  Nearest Gate: %d", this->nearest_gate_);
  }
  
  void HLKLD2410SComponent::reset_input_buffer_() {
-     while (this->available()) {
-         this->read();
+     uint8_t chunk[RX_CHUNK_SIZE];
+     size_t length;
+     while ((length = this->available()) > 0) {
+         if (!this->read_array(chunk, std::min<size_t>(length, RX_CHUNK_SIZE))) {
+             break;
+         }
      }
  }
  
- bool HLKLD2410SComponent::read_byte_(uint8_t *data, uint32_t timeout) {
-     uint32_t start = millis();
-     while ((millis() - start) < timeout) {
-         if (this->available()) {
-             *data = this->read();
-             ESP_LOGV(TAG, "Read byte: 0x%02X", *data);
-             return true;
+ bool HLKLD2410SComponent::write_array_(const uint8_t *data, size_t length) {
+     if (length == 0) {
+         return true;
+     }
+     this->write_array(data, length);
+     // Sampled like the frame path, so a command retried on every loop cannot flood the log
+     HLK_TRACE_SAMPLED(this->tracer_, millis(), "Writing bytes:%s", HexDump(data, length).c_str());
+     return true;
+ }
+ 
+ // Reads up to budget bytes in chunks, stopping early once time_budget µs
+ // have passed; returns how many were read. Both budgets keep one noisy UART
+ // from starving other components. The parser keeps its state, so a frame
+ // cut off here continues with the next call. The clock is checked between
+ // chunks, so at least one chunk is handled per call and the overshoot is
+ // bounded by the time one chunk takes to parse.
+ size_t HLKLD2410SComponent::receive_(uint16_t budget, uint32_t time_budget) {
+     uint8_t chunk[RX_CHUNK_SIZE];
+     size_t total = 0;
+     const uint32_t start = micros();
+     while (total < budget) {
+         if (total > 0 && micros() - start >= time_budget) {
+             this->link_stats_.budget_exhausted++;
+             HLK_TRACE_FULL("Loop budget of %u us exhausted after %u bytes", time_budget, static_cast<unsigned>(total));
+             return total;
+         }
+         size_t length = this->available();
+         if (length == 0) {
+             return total;
          }
-         yield();
+         length = std::min<size_t>(length, std::min<size_t>(RX_CHUNK_SIZE, budget - total));
+         if (!this->read_array(chunk, length)) {
+             return total;
+         }
+         this->read_data_(chunk, length);
+         total += length;
      }
-     ESP_LOGV(TAG, "Read timeout after %ums", timeout);
-     return false;
+     HLK_TRACE_FULL("Read budget of %u bytes exhausted", budget);
+     return total;
  }
  
- bool HLKLD2410SComponent::read_array_(std::vector<uint8_t> &data, size_t count) {
-     data.clear();
-     data.reserve(count);
-     
-     for (size_t i = 0; i < count; i++) {
-         uint8_t byte;
-         if (!this->read_byte_(&byte)) {
-             ESP_LOGW(TAG, "Failed to read byte %d of %d", i, count);
-             return false;
+ #ifdef HLK_LD2410S_RX_TASK
+ void HLKLD2410SComponent::rx_task_(void *arg) {
+     HLKLD2410SComponent *component = static_cast<HLKLD2410SComponent *>(arg);
+     while (true) {
+         if (component->receive_(MAX_BYTES_PER_LOOP) == 0) {
+             vTaskDelay(pdMS_TO_TICKS(RX_TASK_POLL_INTERVAL));
          }
-         data.push_back(byte);
      }
-     return true;
  }
+ #endif
  
- bool HLKLD2410SComponent::write_array_(const std::vector<uint8_t> &data) {
-     if (data.empty()) {
-         return true;
+ void HLKLD2410SComponent::read_data_(const uint8_t *data, size_t length) {
+     HLK_TRACE_FULL("Received %u bytes:%s", static_cast<unsigned>(length), HexDump(data, length).c_str());
+     this->tracer_.count_bytes(length);
+ 
+     // Latency is measured from this read; time spent in the UART FIFO before it is not visible here
+     const uint32_t received_at = micros();
+     for (size_t i = 0; i < length; i++) {
+         if (this->parser_.idle()) {
+             this->frame_started_at_ = received_at;
+         }
+         const FrameType frame = this->parser_.feed(data[i]);
+         if (frame == FrameType::NONE) {
+             continue;
+         }
+         this->tracer_.count_frame(frame);
+ #ifdef HLK_LD2410S_RX_TASK
+         this->rx_frame_.type = frame;
+         this->rx_frame_.length = this->parser_.size();
+         this->rx_frame_.received_at = this->frame_started_at_;
+         std::copy(this->parser_.data(), this->parser_.data() + this->parser_.size(), this->rx_frame_.data.begin());
+         if (!this->rx_queue_.push(this->rx_frame_)) {
+             this->link_stats_.rx_queue_overflows++;
+         }
+ #else
+         this->dispatch_frame_(frame, this->parser_.data(), this->parser_.size(), this->frame_started_at_);
+ #endif
      }
-     this->write_array(data.data(), data.size());
-     
-     std::string debug_str = "Writing bytes:";
-     for (uint8_t byte : data) {
-         char hex[8];
-         snprintf(hex, sizeof(hex), " 0x%02X", byte);
-         debug_str += hex;
+ #ifdef HLK_LD2410S_RX_TASK
+     this->parser_stats_.store(this->parser_.stats());
+ #endif
+ }
+ 
+ void HLKLD2410SComponent::dispatch_frame_(FrameType frame, const uint8_t *data, size_t length, uint32_t received_at) {
+     switch (frame) {
+         case FrameType::ENGINEERING:
+             this->link_stats_.engineering_frames++;
+ #ifdef HLK_LD2410S_ENGINEERING
+ #ifdef HLK_LD2410S_CALIBRATION
+             // Calibration switches a simple mode radar to engineering output for the scan
+             if (this->output_mode_ || this->calibration_.running()) {
+ #else
+             if (this->output_mode_) {
+ #endif
+                 this->handle_engineering_data_(data, length);
+                 this->publish_presence_(received_at);
+             }
+ #endif
+             break;
+         case FrameType::SIMPLE:
+             this->link_stats_.simple_frames++;
+             if (!this->output_mode_) {
+                 this->handle_simple_data_(data, length);
+                 this->publish_presence_(received_at);
+             }
+             break;
+         case FrameType::CONFIG:
+             this->handle_ack_(data, length);
+             break;
+         case FrameType::INVALID:
+             // Counted as bad_footers/overflows; a log line per frame would cost more than the frame on a noisy line
+             HLK_TRACE_SAMPLED(this->tracer_, millis(), "Invalid frame end markers:%s", HexDump(data, length).c_str());
+             this->record_(RecordKind::REJECTED, ByteView(data, length));
+             break;
+         case FrameType::NONE:
+             break;
      }
-     ESP_LOGV(TAG, "%s", debug_str.c_str());
-     
-     return true;
  }
  
- void HLKLD2410SComponent::read_data_() {
-     uint8_t data;
-     static std::vector<uint8_t> buffer;
-     static uint32_t last_debug = 0;
-     const uint32_t now = millis();
-     
-     if (!this->read_byte_(&data, 10)) {
+ #ifdef HLK_LD2410S_ENGINEERING
+ void HLKLD2410SComponent::handle_engineering_data_(const uint8_t *data, size_t length) {
+     // The parser already matched the length field against the bytes received
+     const uint8_t gates = engineering_gate_count(*this->protocol_variant_, EngineeringFrame::Length::read(data));
+     if (gates == 0) {
+         ESP_LOGW(TAG, "%s: Unexpected engineering payload length %u for the %s layout", ERROR_VALIDATION,
+                  EngineeringFrame::Length::read(data), this->protocol_variant_->name);
+         this->record_(RecordKind::REJECTED, ByteView(data, length));
          return;
      }
- 
-     ESP_LOGV(TAG, "Received byte: 0x%02X", data);
-     
-     buffer.push_back(data);
- 
-     if (buffer.size() > 128) {
-         ESP_LOGD(TAG, "Buffer overflow, clearing oldest byte");
-         buffer.erase(buffer.begin());
+     const uint8_t *gate_energy = EngineeringFrame::gate_energy(data);
+     uint8_t padded_energy[MAX_GATES];
+     if (gates < MAX_GATES) {
+         // Short payloads only come from unknown firmware; missing gates read as 0
+         std::copy(gate_energy, gate_energy + gates, padded_energy);
+         std::fill(padded_energy + gates, padded_energy + MAX_GATES, 0);
+         gate_energy = padded_energy;
      }
- 
-     // Debug print buffer contents every second
-     if (now - last_debug > 1000) {
-         std::string debug_str = "Buffer contents:";
-         for (uint8_t byte : buffer) {
-             char hex[8];
-             snprintf(hex, sizeof(hex), " 0x%02X", byte);
-             debug_str += hex;
+     this->record_(RecordKind::ENGINEERING, ByteView(data + EngineeringFrame::SUMMARY, EngineeringFrame::SUMMARY_LENGTH),
+                   ByteView(gate_energy, MAX_GATES));
+ 
+     const uint8_t target_state = EngineeringFrame::State::read(data);
+     const uint16_t distance = EngineeringFrame::Distance::read(data);
+ 
+     HLK_TRACE_FULL("Frame:%s", HexDump(data, length).c_str());
+     HLK_TRACE_SAMPLED(this->tracer_, millis(), "Engineering frame - State: %d, Distance: %d", target_state, distance);
+ 
+     // Only the newest frame is kept; publish_state_() decides what goes out
+     this->radar_state_.presence = target_state > 0;
+     this->radar_state_.distance = this->distance_filter_.update(distance);
+ #ifdef HLK_LD2410S_GATE_SENSORS
+     for (uint8_t i = 0; i < HLK_LD2410S_GATE_SENSORS; i++) {
+         this->radar_state_.gate_energy[i] = gate_energy[i];
+         // Unlike the state above, every frame counts towards the window
+         if (this->gate_energy_sensors_[i] != nullptr) {
+             this->gate_energy_windows_[i].add(gate_energy[i]);
          }
-         ESP_LOGD(TAG, "%s", debug_str.c_str());
-         last_debug = now;
-     }
- 
-     if (this->output_mode_) {  // Engineering mode
-         if (buffer.size() >= 4) {
-             for (size_t i = 0; i <= buffer.size() - 4; i++) {
-                 if (buffer[i] == 0xF4 && buffer[i + 1] == 0xF3 &&
-                     buffer[i + 2] == 0xF2 && buffer[i + 3] == 0xF1) {
-                     
-                     ESP_LOGD(TAG, "Found engineering frame header at position %d", i);
-                     
-                     if (i > 0) {
-                         buffer.erase(buffer.begin(), buffer.begin() + i);
-                     }
- 
-                     if (buffer.size() >= 75) {
-                         if (buffer[71] == 0xF8 && buffer[72] == 0xF7 &&
-                             buffer[73] == 0xF6 && buffer[74] == 0xF5) {
-                             
-                             uint8_t target_state = buffer[7];
-                             uint16_t distance = buffer[8] | (buffer[9] << 8);
-                             
-                             ESP_LOGD(TAG, "Engineering frame - State: %d, Distance: %d", target_state, distance);
-                             
-                             if (this->distance_sensor_ != nullptr) {
-                                 this->distance_sensor_->publish_state(distance / 100.0f);
-                             }
-                             if (this->presence_sensor_ != nullptr) {
-                                 this->presence_sensor_->publish_state(target_state > 0);
-                             }
- 
-                             for (uint8_t i = 0; i < MAX_GATES; i++) {
-                                 if (this->gate_energy_sensors_[i] != nullptr) {
-                                     this->gate_energy_sensors_[i]->publish_state(buffer[12 + i]);
-                                 }
-                             }
- 
-                             buffer.erase(buffer.begin(), buffer.begin() + 75);
-                         } else {
-                             ESP_LOGW(TAG, "Invalid frame end markers");
-                         }
-                     }
-                     break;
-                 }
-             }
+     }
+ #endif
+ #ifdef HLK_LD2410S_ZONES
+     // Zones decide against the tables the radar decides with: as configured, else as read back
+     const uint8_t *trigger = nullptr;
+     const uint8_t *hold = nullptr;
+ #ifdef HLK_LD2410S_THRESHOLDS
+     if (this->has_trigger_thresholds_ && this->has_hold_thresholds_) {
+         trigger = this->trigger_thresholds_.data();
+         hold = this->hold_thresholds_.data();
+     } else if (this->device_mirror_.has_trigger_thresholds() && this->device_mirror_.has_hold_thresholds()) {
+         trigger = this->device_mirror_.trigger_thresholds().data();
+         hold = this->device_mirror_.hold_thresholds().data();
+     }
+ #endif
+     for (uint8_t i = 0; i < this->zone_count_; i++) {
+         // Occupancy changes go out with the frame, like presence
+         if (this->zones_[i].update(gate_energy, trigger, hold) && this->zone_occupancy_sensors_[i] != nullptr) {
+             this->zone_occupancy_sensors_[i]->publish_state(this->zones_[i].occupied());
          }
-     } else {  // Simple mode
-         // Look for complete 5-byte frames
-         while (buffer.size() >= 5) {
-             if (buffer[0] == 0x6E && buffer[4] == 0x62) {  // Valid frame markers
-                 uint8_t target_state = buffer[1];
-                 uint8_t distance = buffer[2];  // Single byte distance
-                 
-                 ESP_LOGD(TAG, "Simple frame - State: %d, Distance: %d cm", target_state, distance);
-                 
-                 // Process data
-                 if (this->distance_sensor_ != nullptr) {
-                     this->distance_sensor_->publish_state(distance / 100.0f);
-                     ESP_LOGD(TAG, "Published distance: %.2f m", distance / 100.0f);
-                 }
-                 if (this->presence_sensor_ != nullptr) {
-                     bool presence = (target_state == 0x02);  // 0x02 indicates presence
-                     this->presence_sensor_->publish_state(presence);
-                     ESP_LOGD(TAG, "Published presence: %s", presence ? "true" : "false");
-                 }
+     }
+ #endif
+ #ifdef HLK_LD2410S_ENERGY_WINDOW
+     this->radar_state_.has_gate_energy = true;
+ #endif
+     this->radar_state_.valid = true;
+ 
+ #ifdef HLK_LD2410S_CALIBRATION
+     if (this->calibration_.running()) {
+         this->calibration_.add(gate_energy);
+     }
+ #endif
+ }
+ #endif
  
-                 // Remove processed frame
-                 buffer.erase(buffer.begin(), buffer.begin() + 5);
-             } else {
-                 // Not a valid frame start, remove first byte
-                 buffer.erase(buffer.begin());
-             }
+ void HLKLD2410SComponent::handle_simple_data_(const uint8_t *data, size_t length) {
+     if (length < SimpleFrame::LENGTH) {
+         ESP_LOGW(TAG, "%s: Simple data frame too short", ERROR_VALIDATION);
+         this->record_(RecordKind::REJECTED, ByteView(data, length));
+         return;
+     }
+     this->record_(RecordKind::SIMPLE, ByteView(data + SimpleFrame::SUMMARY, SimpleFrame::SUMMARY_LENGTH));
+ 
+     const uint8_t target_state = SimpleFrame::State::read(data);
+     const uint8_t distance = SimpleFrame::Distance::read(data);  // Single byte distance
+ 
+     HLK_TRACE_FULL("Frame:%s", HexDump(data, length).c_str());
+     HLK_TRACE_SAMPLED(this->tracer_, millis(), "Simple frame - State: %d, Distance: %d cm", target_state, distance);
+ 
+     this->radar_state_.presence = (target_state == 0x02);  // 0x02 indicates presence
+     this->radar_state_.distance = this->distance_filter_.update(distance);
+     this->radar_state_.valid = true;
+ }
+ 
+ #ifdef HLK_LD2410S_RECORDER_SIZE
+ void HLKLD2410SComponent::record_(RecordKind kind, ByteView first, ByteView second) {
+     this->recorder_.record(kind, millis(), first, second);
+ }
+ #else
+ void HLKLD2410SComponent::record_(RecordKind /*kind*/, ByteView /*first*/, ByteView /*second*/) {}
+ #endif
+ 
+ void HLKLD2410SComponent::dump_flight_recorder() {
+ #ifdef HLK_LD2410S_RECORDER_SIZE
+     const size_t size = this->recorder_.dump_size();
+     ESP_LOGI(TAG, "Recorder dump: %u records, %u bytes", static_cast<unsigned>(this->recorder_.count()),
+              static_cast<unsigned>(size));
+     uint8_t chunk[RECORDER_LINE_BYTES];
+     char line[RECORDER_LINE_BYTES / 3 * 4 + 1];
+     for (size_t offset = 0; offset < size; offset += RECORDER_LINE_BYTES) {
+         const size_t length = std::min<size_t>(RECORDER_LINE_BYTES, size - offset);
+         for (size_t i = 0; i < length; i++) {
+             chunk[i] = this->recorder_.dump_byte(offset + i);
          }
+         base64_encode_into(chunk, length, line);
+         ESP_LOGI(TAG, "Recorder data: %s", line);
      }
+     ESP_LOGI(TAG, "Recorder dump end");
+ #else
+     ESP_LOGW(TAG, "Flight recorder is not enabled");
+ #endif
  }
  
- void HLKLD2410SComponent::handle_engineering_data_(const std::vector<uint8_t> &data) {
-     if (data.size() < DATA_FRAME_ENGINEERING_LENGTH) {
-         ESP_LOGW(TAG, "%s: Engineering data frame too short", ERROR_VALIDATION);
+ void HLKLD2410SComponent::publish_presence_(uint32_t received_at) {
+     // Transitions go out as soon as the frame is decoded; publish_state_() only sends heartbeats
+     if (this->presence_sensor_ == nullptr || !this->radar_state_.valid) {
          return;
      }
+     const bool presence = this->radar_state_.presence;
+     if (!this->presence_publish_.changed(presence)) {
+         return;
+     }
+     this->presence_sensor_->publish_state(presence);
+     this->presence_publish_.mark_published(presence, millis());
+     this->presence_latency_.record(micros() - received_at);
+     HLK_TRACE_FULL("Published presence: %s", presence ? "true" : "false");
+ }
  
-     const uint8_t head = data[0];
-     if (head != 0xAA) {
-         ESP_LOGW(TAG, "%s: Invalid engineering data header", ERROR_VALIDATION);
+ void HLKLD2410SComponent::publish_state_(uint32_t now) {
+     if (!this->radar_state_.valid) {
          return;
      }
  
-     const uint8_t target_state = data[1];
-     const uint16_t moving_distance = data[2] | (data[3] << 8);
-     const uint16_t static_distance = data[4] | (data[5] << 8);
-     
      if (this->distance_sensor_ != nullptr) {
-         float distance = (target_state & 0x01) ? moving_distance / 100.0f : 
-                         (target_state & 0x02) ? static_distance / 100.0f : 0.0f;
-         this->distance_sensor_->publish_state(distance);
+         const float distance = this->radar_state_.distance / 100.0f;
+         if (this->distance_publish_.should_publish(distance, now, this->throttle_, this->distance_deadband_,
+                                                    this->max_silence_)) {
+             this->distance_sensor_->publish_state(distance);
+             HLK_TRACE_FULL("Published distance: %.2f m", distance);
+         }
      }
  
+     // Presence changes were published by publish_presence_(); this only keeps the heartbeat
      if (this->presence_sensor_ != nullptr) {
-         this->presence_sensor_->publish_state(target_state > 0);
+         const bool presence = this->radar_state_.presence;
+         if (this->presence_publish_.should_publish(presence, now, this->throttle_, 0.0f, this->max_silence_)) {
+             this->presence_sensor_->publish_state(presence);
+             HLK_TRACE_FULL("Published presence: %s", presence ? "true" : "false");
+         }
      }
  
-     for (uint8_t i = 0; i < MAX_GATES; i++) {
-         if (this->gate_energy_sensors_[i] != nullptr) {
-             const uint8_t energy = data[i + 6];
-             this->gate_energy_sensors_[i]->publish_state(energy);
-         }
+ #ifdef HLK_LD2410S_ENERGY_WINDOW
+     if (this->radar_state_.has_gate_energy) {
+         this->publish_energy_(now);
      }
+ #endif
  }
  
- void HLKLD2410SComponent::handle_simple_data_(const std::vector<uint8_t> &data) {
-     if (data.size() < DATA_FRAME_SIMPLE_LENGTH) {
-         ESP_LOGW(TAG, "%s: Simple data frame too short", ERROR_VALIDATION);
+ #ifdef HLK_LD2410S_ENERGY_WINDOW
+ void HLKLD2410SComponent::publish_energy_(uint32_t now) {
+     // Without a window every gate and zone is rate limited like the other entities
+     if (this->gate_energy_window_ == 0) {
+ #ifdef HLK_LD2410S_GATE_SENSORS
+         for (uint8_t i = 0; i < HLK_LD2410S_GATE_SENSORS; i++) {
+             if (this->gate_energy_sensors_[i] == nullptr) {
+                 continue;
+             }
+             const float energy = this->radar_state_.gate_energy[i];
+             if (this->gate_energy_publish_[i].should_publish(energy, now, this->throttle_, 0.0f, this->max_silence_)) {
+                 this->gate_energy_sensors_[i]->publish_state(energy);
+             }
+         }
+ #endif
+ #ifdef HLK_LD2410S_ZONES
+         for (uint8_t i = 0; i < this->zone_count_; i++) {
+             if (this->zone_energy_sensors_[i] == nullptr) {
+                 continue;
+             }
+             const float energy = this->zones_[i].energy();
+             if (this->zone_energy_publish_[i].should_publish(energy, now, this->throttle_, 0.0f, this->max_silence_)) {
+                 this->zone_energy_sensors_[i]->publish_state(energy);
+             }
+         }
+ #endif
          return;
      }
  
-     const uint8_t head = data[0];
-     if (head != 0xAA) {
-         ESP_LOGW(TAG, "%s: Invalid simple data header", ERROR_VALIDATION);
+     if (now - this->gate_energy_window_start_ < this->gate_energy_window_) {
          return;
      }
- 
-     const uint8_t target_state = data[1];
-     const uint16_t distance = data[2] | (data[3] << 8);
- 
-     if (this->distance_sensor_ != nullptr) {
-         this->distance_sensor_->publish_state(distance / 100.0f);
+     this->gate_energy_window_start_ = now;
+ #ifdef HLK_LD2410S_GATE_SENSORS
+     for (uint8_t i = 0; i < HLK_LD2410S_GATE_SENSORS; i++) {
+         GateWindow &window = this->gate_energy_windows_[i];
+         if (this->gate_energy_sensors_[i] == nullptr || window.count() == 0) {
+             continue;
+         }
+         this->gate_energy_sensors_[i]->publish_state(window.value(this->gate_energy_aggregates_[i]));
+         window.reset();
      }
+ #endif
+ #ifdef HLK_LD2410S_ZONES
+     for (uint8_t i = 0; i < this->zone_count_; i++) {
+         GateWindow &window = this->zones_[i].window();
+         if (this->zone_energy_sensors_[i] != nullptr && window.count() > 0) {
+             this->zone_energy_sensors_[i]->publish_state(window.value(this->zone_energy_aggregates_[i]));
+         }
+         window.reset();
+     }
+ #endif
+ }
+ #endif
  
-     if (this->presence_sensor_ != nullptr) {
-         this->presence_sensor_->publish_state(target_state > 0);
+ void HLKLD2410SComponent::publish_diagnostics_(uint32_t now) {
+     if (now - this->last_diagnostics_publish_ < this->diagnostics_interval_) {
+         return;
+     }
+     this->last_diagnostics_publish_ = now;
+ 
+ #ifdef HLK_LD2410S_RX_TASK
+     const ParserStatsSnapshot &parser = this->parser_stats_;
+ #else
+     const ParserStats &parser = this->parser_.stats();
+ #endif
+     this->publish_diagnostic_(DiagnosticSensor::SIMPLE_FRAMES, this->link_stats_.simple_frames);
+     this->publish_diagnostic_(DiagnosticSensor::ENGINEERING_FRAMES, this->link_stats_.engineering_frames);
+     this->publish_diagnostic_(DiagnosticSensor::RESYNC_BYTES, parser.discarded_bytes);
+     this->publish_diagnostic_(DiagnosticSensor::BAD_FOOTERS, parser.bad_footers);
+     this->publish_diagnostic_(DiagnosticSensor::BUFFER_OVERFLOWS, parser.overflows);
+     this->publish_diagnostic_(DiagnosticSensor::ACK_TIMEOUTS, this->link_stats_.ack_timeouts);
+     this->publish_diagnostic_(DiagnosticSensor::FAILED_RESPONSES, this->link_stats_.failed_responses);
+     this->publish_diagnostic_(DiagnosticSensor::RX_QUEUE_OVERFLOWS, this->link_stats_.rx_queue_overflows);
+     this->publish_diagnostic_(DiagnosticSensor::BUDGET_EXHAUSTED, this->link_stats_.budget_exhausted);
+ 
+     // Latency and loop time describe the window since the last publish
+     if (this->ack_latency_.count() > 0) {
+         this->publish_diagnostic_(DiagnosticSensor::ACK_LATENCY_MIN, this->ack_latency_.min());
+         this->publish_diagnostic_(DiagnosticSensor::ACK_LATENCY_AVG, this->ack_latency_.avg());
+         this->publish_diagnostic_(DiagnosticSensor::ACK_LATENCY_MAX, this->ack_latency_.max());
+         this->ack_latency_.reset();
+     }
+     if (this->presence_latency_.count() > 0) {
+         this->publish_diagnostic_(DiagnosticSensor::PRESENCE_LATENCY_MIN, this->presence_latency_.min());
+         this->publish_diagnostic_(DiagnosticSensor::PRESENCE_LATENCY_AVG, this->presence_latency_.avg());
+         this->publish_diagnostic_(DiagnosticSensor::PRESENCE_LATENCY_MAX, this->presence_latency_.max());
+         this->presence_latency_.reset();
+     }
+     if (this->loop_time_.count() > 0) {
+         this->publish_diagnostic_(DiagnosticSensor::LOOP_TIME_P50, this->loop_time_.percentile(50));
+         this->publish_diagnostic_(DiagnosticSensor::LOOP_TIME_P95, this->loop_time_.percentile(95));
+         this->publish_diagnostic_(DiagnosticSensor::LOOP_TIME_P99, this->loop_time_.percentile(99));
+         this->loop_time_.reset();
      }
  }
  
- bool HLKLD2410SComponent::enable_configuration_() {
-     if (this->config_mode_sensor_ != nullptr) {
-         this->config_mode_sensor_->publish_state(true);
+ void HLKLD2410SComponent::publish_diagnostic_(DiagnosticSensor type, float value) {
+     sensor::Sensor *diagnostic_sensor = this->diagnostic_sensors_[static_cast<uint8_t>(type)];
+     if (diagnostic_sensor != nullptr) {
+         diagnostic_sensor->publish_state(value);
      }
+ }
  
-     return this->send_command_(CommandWord::ENABLE_CONFIGURATION);
+ void HLKLD2410SComponent::enable_configuration_(CommandStep step, uint32_t context) {
+     this->queue_command_(CommandWord::ENABLE_CONFIGURATION, {}, step, context);
  }
  
- bool HLKLD2410SComponent::disable_configuration_() {
-     if (this->config_mode_sensor_ != nullptr) {
-         this->config_mode_sensor_->publish_state(false);
+ void HLKLD2410SComponent::enter_configuration_mode_() {
+     // Entering configuration mode in the middle of a session would leave it in an unknown state
+     if (!this->command_queue_.empty()) {
+         ESP_LOGW(TAG, "Configuration session in progress, not entering configuration mode");
+         return;
      }
+     this->enable_configuration_();
+ }
  
-     return this->send_command_(CommandWord::DISABLE_CONFIGURATION);
+ void HLKLD2410SComponent::disable_configuration_(CommandStep step, uint32_t context) {
+     this->queue_command_(CommandWord::DISABLE_CONFIGURATION, {}, step, context);
  }
  
  void HLKLD2410SComponent::apply_cached_config_() {
-     bool success = true;
+     this->config_failures_ = 0;
+ 
+     this->set_output_mode_();
+     this->stage_parameters_(this->pending_parameters_);
+     this->flush_parameters_();
  
-     if (!this->set_output_mode_()) {
-         ESP_LOGE(TAG, "%s: Failed to set output mode", ERROR_CONFIGURATION);
-         success = false;
+ #ifdef HLK_LD2410S_THRESHOLDS
+     if (this->has_trigger_thresholds_ && this->has_hold_thresholds_) {
+         this->set_trigger_thresholds_();
+         this->set_hold_thresholds_();
      }
+ #endif
  
-     if (!this->set_response_speed_()) {
-         ESP_LOGE(TAG, "%s: Failed to set response speed", ERROR_CONFIGURATION);
-         success = false;
+     if (this->trigger_factor_ > 0 && this->hold_factor_ > 0 && this->scan_time_ > 0) {
+         this->set_auto_threshold_();
      }
+ }
+ 
+ void HLKLD2410SComponent::stage_parameters_(ParameterSet &parameters) const {
+     parameters.add(ParameterId::RESPONSE_SPEED, this->response_speed_);
+     parameters.add(ParameterId::UNMANNED_DELAY, this->unmanned_delay_);
+     parameters.add(ParameterId::STATUS_REPORT_FREQUENCY, report_frequency_value(this->status_report_frequency_));
+     parameters.add(ParameterId::DISTANCE_REPORT_FREQUENCY, report_frequency_value(this->distance_report_frequency_));
+     parameters.add(ParameterId::FARTHEST_GATE, this->farthest_gate_);
+     parameters.add(ParameterId::NEAREST_GATE, this->nearest_gate_);
+ }
  
-     if (!this->set_unmanned_delay_()) {
-         ESP_LOGE(TAG, "%s: Failed to set unmanned delay", ERROR_CONFIGURATION);
-         success = false;
+ bool HLKLD2410SComponent::update_output_mode(bool output_mode) {
+ #ifndef HLK_LD2410S_ENGINEERING
+     if (output_mode) {
+         ESP_LOGW(TAG, "%s: Engineering mode is not compiled in; enable output_mode in the YAML", ERROR_CONFIGURATION);
+         return false;
      }
+ #endif
+     this->output_mode_ = output_mode;
+     this->config_changes_ |= CHANGE_OUTPUT_MODE;
+     this->schedule_config_session_();
+     return true;
+ }
  
-     if (!this->set_status_report_frequency_()) {
-         ESP_LOGE(TAG, "%s: Failed to set status report frequency", ERROR_CONFIGURATION);
-         success = false;
+ bool HLKLD2410SComponent::update_response_speed(uint8_t response_speed) {
+     if (response_speed != MIN_RESPONSE_SPEED && response_speed != MAX_RESPONSE_SPEED) {
+         ESP_LOGW(TAG, "%s: Response speed must be %u or %u", ERROR_VALIDATION, MIN_RESPONSE_SPEED, MAX_RESPONSE_SPEED);
+         return false;
      }
+     this->response_speed_ = response_speed;
+     this->set_response_speed_();
+     this->schedule_config_session_();
+     return true;
+ }
  
-     if (!this->set_distance_report_frequency_()) {
-         ESP_LOGE(TAG, "%s: Failed to set distance report frequency", ERROR_CONFIGURATION);
-         success = false;
+ bool HLKLD2410SComponent::update_control(Control control, float value) {
+ #ifdef HLK_LD2410S_ADAPTIVE_REPORT
+     // Also catches templated and lambda values that validation could not see
+     if (this->adaptive_report_.enabled() &&
+         (control == Control::STATUS_REPORT_FREQUENCY || control == Control::DISTANCE_REPORT_FREQUENCY)) {
+         ESP_LOGW(TAG, "%s: Report frequencies follow adaptive_report", ERROR_CONFIGURATION);
+         return false;
+     }
+ #endif
+     // Gates and the delay are whole numbers; only report frequencies take tenths of a Hz
+     const bool frequency =
+         control == Control::STATUS_REPORT_FREQUENCY || control == Control::DISTANCE_REPORT_FREQUENCY;
+     if (std::isnan(value) || (!frequency && value != roundf(value))) {
+         ESP_LOGW(TAG, "%s: Value %.2f is not valid for control %u", ERROR_VALIDATION, value,
+                  static_cast<uint8_t>(control));
+         return false;
      }
+     switch (control) {
+         case Control::UNMANNED_DELAY:
+             if (value < MIN_UNMANNED_DELAY || value > MAX_UNMANNED_DELAY) {
+                 break;
+             }
+             this->unmanned_delay_ = static_cast<uint8_t>(lroundf(value));
+             this->set_unmanned_delay_();
+             this->schedule_config_session_();
+             return true;
+         case Control::STATUS_REPORT_FREQUENCY:
+             if (value < MIN_REPORT_FREQUENCY || value > MAX_REPORT_FREQUENCY) {
+                 break;
+             }
+             this->status_report_frequency_ = value;
+             this->set_status_report_frequency_();
+             this->schedule_config_session_();
+             return true;
+         case Control::DISTANCE_REPORT_FREQUENCY:
+             if (value < MIN_REPORT_FREQUENCY || value > MAX_REPORT_FREQUENCY) {
+                 break;
+             }
+             this->distance_report_frequency_ = value;
+             this->set_distance_report_frequency_();
+             this->schedule_config_session_();
+             return true;
+         case Control::FARTHEST_GATE:
+             if (value < MIN_FARTHEST_GATE || value > MAX_FARTHEST_GATE) {
+                 break;
+             }
+             if (value < this->nearest_gate_) {
+                 ESP_LOGW(TAG, "%s: Farthest gate %.0f is below nearest gate %u", ERROR_VALIDATION, value,
+                          this->nearest_gate_);
+                 return false;
+             }
+             this->farthest_gate_ = static_cast<uint8_t>(lroundf(value));
+             this->set_farthest_gate_();
+             this->schedule_config_session_();
+             return true;
+         case Control::NEAREST_GATE:
+             if (value < MIN_NEAREST_GATE || value > MAX_NEAREST_GATE) {
+                 break;
+             }
+             if (value > this->farthest_gate_) {
+                 ESP_LOGW(TAG, "%s: Nearest gate %.0f is beyond farthest gate %u", ERROR_VALIDATION, value,
+                          this->farthest_gate_);
+                 return false;
+             }
+             this->nearest_gate_ = static_cast<uint8_t>(lroundf(value));
+             this->set_nearest_gate_();
+             this->schedule_config_session_();
+             return true;
+         case Control::COUNT:
+             break;
+     }
+     ESP_LOGW(TAG, "%s: Value %.1f out of range for control %u", ERROR_VALIDATION, value, static_cast<uint8_t>(control));
+     return false;
+ }
  
-     if (!this->set_farthest_gate_()) {
-         ESP_LOGE(TAG, "%s: Failed to set farthest gate", ERROR_CONFIGURATION);
-         success = false;
+ bool HLKLD2410SComponent::update_gate_range(uint8_t nearest, uint8_t farthest) {
+     if (nearest > farthest) {
+         ESP_LOGW(TAG, "%s: Nearest gate %u is beyond farthest gate %u", ERROR_VALIDATION, nearest, farthest);
+         return false;
+     }
+     // Move the end that keeps the range ordered in between first
+     if (farthest >= this->farthest_gate_) {
+         return this->update_control(Control::FARTHEST_GATE, farthest) && this->update_control(Control::NEAREST_GATE, nearest);
      }
+     return this->update_control(Control::NEAREST_GATE, nearest) && this->update_control(Control::FARTHEST_GATE, farthest);
+ }
  
-     if (!this->set_nearest_gate_()) {
-         ESP_LOGE(TAG, "%s: Failed to set nearest gate", ERROR_CONFIGURATION);
-         success = false;
+ #ifdef HLK_LD2410S_THRESHOLDS
+ bool HLKLD2410SComponent::update_gate_thresholds(uint8_t gate, uint8_t trigger, uint8_t hold) {
+     if (gate >= MAX_GATES || trigger > MAX_GATE_THRESHOLD || hold > MAX_GATE_THRESHOLD) {
+         ESP_LOGW(TAG, "%s: Invalid thresholds for gate %u", ERROR_VALIDATION, gate);
+         return false;
      }
+     // Thresholds are written as whole tables, so a baseline is needed to change one gate
+     if (!this->has_trigger_thresholds_ || !this->has_hold_thresholds_) {
+         ESP_LOGW(TAG, "%s: Configure trigger_thresholds/hold_thresholds or calibrate before changing single gates",
+                  ERROR_CONFIGURATION);
+         return false;
+     }
+     this->trigger_thresholds_[gate] = trigger;
+     this->hold_thresholds_[gate] = hold;
+     this->config_changes_ |= CHANGE_TRIGGER_THRESHOLDS | CHANGE_HOLD_THRESHOLDS;
+     this->schedule_config_session_();
+     return true;
+ }
+ #endif
  
-     if (!this->trigger_thresholds_.empty() && !this->hold_thresholds_.empty()) {
-         if (!this->set_trigger_thresholds_()) {
-             ESP_LOGE(TAG, "%s: Failed to set trigger thresholds", ERROR_CONFIGURATION);
-             success = false;
-         }
+ void HLKLD2410SComponent::schedule_config_session_() {
+     // Every change restarts the debounce window, so a dragged slider ends in one session
+     this->last_config_change_ = millis();
+     this->config_session_pending_ = true;
+ }
  
-         if (!this->set_hold_thresholds_()) {
-             ESP_LOGE(TAG, "%s: Failed to set hold thresholds", ERROR_CONFIGURATION);
-             success = false;
-         }
+ void HLKLD2410SComponent::run_config_session_(uint32_t now) {
+     if (!this->config_session_pending_ || now - this->last_config_change_ < this->config_debounce_) {
+         return;
+     }
+     // Never interleave with the boot session or a calibration
+     if (!this->command_queue_.empty()) {
+         return;
      }
+ #ifdef HLK_LD2410S_CALIBRATION
+     if (this->calibration_.running()) {
+         return;
+     }
+ #endif
+     this->config_session_pending_ = false;
  
-     if (this->trigger_factor_ > 0 && this->hold_factor_ > 0 && this->scan_time_ > 0) {
-         if (!this->set_auto_threshold_()) {
-             ESP_LOGE(TAG, "%s: Failed to set auto threshold", ERROR_CONFIGURATION);
-             success = false;
-         }
+     const uint8_t changes = this->config_changes_;
+     this->config_changes_ = 0;
+     if (changes == 0 && this->pending_parameters_.empty()) {
+         return;
      }
  
-     if (!success) {
-         ESP_LOGE(TAG, "%s: One or more configuration commands failed", ERROR_CONFIGURATION);
+     ESP_LOGI(TAG, "Applying runtime configuration changes");
+     this->session_changes_ = changes;
+     this->enable_configuration_(CommandStep::SESSION_CONFIG_MODE);
+ }
+ 
+ void HLKLD2410SComponent::session_state_read_() {
+     const uint8_t changes = this->session_changes_;
+     if (changes & CHANGE_OUTPUT_MODE) {
+         this->set_output_mode_();
+     }
+     this->flush_parameters_();
+ #ifdef HLK_LD2410S_THRESHOLDS
+     if (changes & CHANGE_TRIGGER_THRESHOLDS) {
+         this->set_trigger_thresholds_();
      }
+     if (changes & CHANGE_HOLD_THRESHOLDS) {
+         this->set_hold_thresholds_();
+     }
+ #endif
+     this->disable_configuration_(CommandStep::SESSION_CONFIGURED);
  }
  
- bool HLKLD2410SComponent::send_command_(CommandWord cmd, const std::vector<uint8_t> &payload) {
-     std::vector<uint8_t> data;
-     data.insert(data.end(), CONFIG_FRAME_HEADER, CONFIG_FRAME_HEADER + 4);
-     
-     uint16_t length = payload.size() + 1;
-     data.push_back(length & 0xFF);
-     data.push_back((length >> 8) & 0xFF);
-     
-     data.push_back(static_cast<uint8_t>(cmd));
-     data.insert(data.end(), payload.begin(), payload.end());
-     
-     data.push_back(this->calculate_checksum_(data));
-     
-     if (!this->write_array_(data)) {
-         ESP_LOGE(TAG, "%s: Failed to send command 0x%04X", ERROR_COMMUNICATION, static_cast<uint16_t>(cmd));
-         return false;
+ #ifdef HLK_LD2410S_ADAPTIVE_REPORT
+ void HLKLD2410SComponent::adapt_report_frequency_(uint32_t now) {
+     // Never interleave with another session; the switch is picked up on the first loop after it
+     if (!this->adaptive_report_.enabled() || !this->radar_state_.valid || !this->command_queue_.empty()) {
+         return;
+     }
+     const bool switched = this->adaptive_report_.update(this->radar_state_.presence, now) != 0.0f;
+     const float frequency = this->adaptive_report_.frequency();
+     const uint32_t value = report_frequency_value(frequency);
+     // The mirror only takes the value once the radar acknowledged it, so a failed write is retried
+     if (this->device_mirror_.matches(ParameterId::DISTANCE_REPORT_FREQUENCY, value)) {
+         return;
+     }
+     if (!switched && now - this->adaptive_report_written_ < ADAPTIVE_REPORT_RETRY_INTERVAL) {
+         return;
+     }
+     this->adaptive_report_written_ = now;
+     ESP_LOGD(TAG, "Room %s, %s distance reports at %.1f Hz", this->adaptive_report_.active() ? "occupied" : "empty",
+              switched ? "switching" : "retrying", frequency);
+ 
+     // A single write with no debounce and no read-back. Status reports stay at the active frequency so
+     // presence is never reported late. The configured distance frequency stays at the active one, so a
+     // radar left at the idle frequency differs from it at the next boot and is written again.
+     ParameterSet parameters;
+     parameters.add(ParameterId::DISTANCE_REPORT_FREQUENCY, value);
+     uint8_t payload[MAX_COMMAND_PAYLOAD];
+     const size_t count = parameters.encode(0, payload);
+     this->enable_configuration_();
+     this->queue_command_(CommandWord::WRITE_PARAMETERS, ByteView(payload, count * ParameterEntryLayout::SIZE),
+                          CommandStep::PARAMETERS_WRITTEN);
+     this->disable_configuration_();
+ }
+ #endif
+ 
+ void HLKLD2410SComponent::publish_controls_() {
+ #ifdef HLK_LD2410S_CONTROLS
+     const float values[CONTROL_COUNT] = {
+         static_cast<float>(this->unmanned_delay_),
+         this->status_report_frequency_,
+         this->distance_report_frequency_,
+         static_cast<float>(this->farthest_gate_),
+         static_cast<float>(this->nearest_gate_),
+     };
+     for (uint8_t i = 0; i < CONTROL_COUNT; i++) {
+         if (this->control_numbers_[i] != nullptr) {
+             this->control_numbers_[i]->publish_state(values[i]);
+         }
+     }
+     if (this->output_mode_select_ != nullptr) {
+         this->output_mode_select_->publish_state(this->output_mode_ ? "Engineering" : "Simple");
      }
-     
-     return this->wait_for_ack_();
+     if (this->response_speed_select_ != nullptr) {
+         this->response_speed_select_->publish_state(this->response_speed_ == MAX_RESPONSE_SPEED ? "Fast" : "Normal");
+     }
+ #endif
  }
  
- bool HLKLD2410SComponent::wait_for_ack_(uint32_t timeout) {
-     uint32_t start = millis();
-     while ((millis() - start) < timeout) {
-         if (this->available()) {
-             if (this->read_ack_()) {
-                 return true;
+ #ifdef HLK_LD2410S_CALIBRATION
+ void HLKLD2410SComponent::start_calibration_() {
+     if (this->calibration_.running()) {
+         ESP_LOGW(TAG, "Calibration already running");
+         return;
+     }
+     if (!this->command_queue_.empty()) {
+         ESP_LOGW(TAG, "Configuration session in progress, calibrate again once it has finished");
+         return;
+     }
+ 
+     // Collection only starts once the radar is streaming engineering frames
+     this->enable_configuration_(CommandStep::CALIBRATION_CONFIG_MODE);
+ }
+ 
+ void HLKLD2410SComponent::finish_calibration_() {
+     this->calibration_.stop();
+     const bool enough_frames = this->calibration_.count() >= MIN_CALIBRATION_FRAMES;
+     if (!enough_frames) {
+         ESP_LOGE(TAG, "%s: Only %u engineering frames during calibration", ERROR_CONFIGURATION,
+                  this->calibration_.count());
+     }
+ 
+     std::array<uint8_t, MAX_GATES> trigger;
+     std::array<uint8_t, MAX_GATES> hold;
+     if (enough_frames) {
+         this->calibration_.thresholds(this->trigger_sigma_, trigger.data());
+         this->calibration_.thresholds(this->hold_sigma_, hold.data());
+         this->set_trigger_thresholds(trigger);
+         this->set_hold_thresholds(hold);
+         ESP_LOGI(TAG, "Calibrated from %u frames", this->calibration_.count());
+         for (uint8_t i = 0; i < MAX_GATES; i++) {
+             ESP_LOGD(TAG, "  Gate %u: trigger %u, hold %u", i, trigger[i], hold[i]);
+             if (this->trigger_threshold_sensors_[i] != nullptr) {
+                 this->trigger_threshold_sensors_[i]->publish_state(trigger[i]);
+             }
+             if (this->hold_threshold_sensors_[i] != nullptr) {
+                 this->hold_threshold_sensors_[i]->publish_state(hold[i]);
              }
          }
-         yield();
      }
-     ESP_LOGW(TAG, "%s: No ACK received", ERROR_TIMEOUT);
-     return false;
+ 
+     // Write the result and restore simple output in one session
+     if (!enough_frames && this->output_mode_) {
+         return;
+     }
+     this->enable_configuration_(CommandStep::CALIBRATION_RESULT, enough_frames ? 1 : 0);
+ }
+ #endif
+ 
+ void HLKLD2410SComponent::queue_command_(CommandWord cmd, ByteView payload, CommandStep step, uint32_t context,
+                                          uint32_t timeout, uint8_t retries) {
+     PendingCommand command;
+     command.cmd = cmd;
+     command.step = step;
+     command.context = context;
+     command.timeout = timeout;
+     command.retries = retries;
+     if (payload.size > MAX_COMMAND_PAYLOAD) {
+         ESP_LOGE(TAG, "%s: Payload too large for command 0x%02X", ERROR_COMMUNICATION, static_cast<uint8_t>(cmd));
+         this->handle_result_(command, false, nullptr, 0);
+         return;
+     }
+     std::copy(payload.data, payload.data + payload.size, command.payload.begin());
+     command.payload_length = payload.size;
+     if (this->command_queue_.full()) {
+         ESP_LOGW(TAG, "%s: Command queue full, dropping command 0x%02X", ERROR_COMMUNICATION, static_cast<uint8_t>(cmd));
+         this->handle_result_(command, false, nullptr, 0);
+         return;
+     }
+     this->command_queue_.push(command);
  }
  
- bool HLKLD2410SComponent::read_ack_() {
-     std::vector<uint8_t> ack_data;
-     if (!this->read_array_(ack_data, CONFIG_FRAME_MIN_LENGTH)) {
-         return false;
+ void HLKLD2410SComponent::process_command_queue_() {
+     if (this->command_queue_.empty()) {
+         return;
      }
  
-     return this->validate_response_(ack_data);
+     PendingCommand &command = this->command_queue_.front();
+     const uint32_t now = millis();
+     if (!command.in_flight) {
+         command.in_flight = true;
+         command.sent_at = now;
+         this->send_command_(command);
+         return;
+     }
+ 
+     if (now - command.sent_at < command.timeout) {
+         return;
+     }
+ 
+     if (command.retries > 0) {
+         this->link_stats_.ack_timeouts++;
+         command.retries--;
+         command.sent_at = now;
+         ESP_LOGW(TAG, "%s: No ACK for command 0x%02X, retrying", ERROR_TIMEOUT, static_cast<uint8_t>(command.cmd));
+         this->send_command_(command);
+         return;
+     }
+ 
+     this->link_stats_.ack_timeouts++;
+     ESP_LOGW(TAG, "%s: No ACK received for command 0x%02X", ERROR_TIMEOUT, static_cast<uint8_t>(command.cmd));
+     this->complete_command_(false, nullptr, 0);
  }
  
- bool HLKLD2410SComponent::validate_response_(const std::vector<uint8_t> &data) {
-     if (data.size() < CONFIG_FRAME_MIN_LENGTH) {
-         ESP_LOGW(TAG, "%s: Response too short", ERROR_VALIDATION);
-         return false;
+ void HLKLD2410SComponent::complete_command_(bool success, const uint8_t *data, size_t length) {
+     // Pop before handling the result so the step can queue follow-up commands
+     const PendingCommand command = this->command_queue_.front();
+     this->command_queue_.pop();
+     this->handle_result_(command, success, data, length);
+ }
+ 
+ void HLKLD2410SComponent::handle_result_(const PendingCommand &command, bool success, const uint8_t *data,
+                                          size_t length) {
+     if (success && this->config_mode_sensor_ != nullptr) {
+         if (command.cmd == CommandWord::ENABLE_CONFIGURATION) {
+             this->config_mode_sensor_->publish_state(true);
+         } else if (command.cmd == CommandWord::DISABLE_CONFIGURATION) {
+             this->config_mode_sensor_->publish_state(false);
+         }
      }
  
-     for (size_t i = 0; i < 4; i++) {
-         if (data[i] != CONFIG_FRAME_HEADER[i]) {
-             ESP_LOGW(TAG, "%s: Invalid response header", ERROR_VALIDATION);
-             return false;
+     switch (command.step) {
+         case CommandStep::NONE:
+             break;
+         case CommandStep::BOOT_CONFIG_MODE:
+             if (!success) {
+                 ESP_LOGE(TAG, "%s: Failed to enable configuration mode", ERROR_CONFIGURATION);
+                 break;
+             }
+             this->queue_command_(CommandWord::READ_FIRMWARE_VERSION, {}, CommandStep::BOOT_FIRMWARE_VERSION);
+             break;
+         case CommandStep::BOOT_FIRMWARE_VERSION:
+             if (!success) {
+                 ESP_LOGW(TAG, "%s: Failed to read firmware version", ERROR_CONFIGURATION);
+                 length = 0;
+             }
+             this->apply_firmware_version_(data, length);
+             this->configure_(data, length);
+             break;
+         case CommandStep::BOOT_STATE_READ:
+             this->boot_state_read_();
+             break;
+         case CommandStep::BOOT_CONFIGURED:
+             if (!success) {
+                 ESP_LOGE(TAG, "%s: Failed to disable configuration mode", ERROR_CONFIGURATION);
+             }
+             if (this->config_failures_ > 0) {
+                 ESP_LOGE(TAG, "%s: One or more configuration commands failed", ERROR_CONFIGURATION);
+                 break;
+             }
+             if (success && this->boot_firmware_hash_ != 0) {
+                 StoredConfig stored{this->boot_config_hash_, this->boot_firmware_hash_};
+                 this->config_pref_.save(&stored);
+             }
+             break;
+         case CommandStep::SESSION_CONFIG_MODE:
+             if (!success) {
+                 ESP_LOGE(TAG, "%s: Failed to enable configuration mode", ERROR_CONFIGURATION);
+                 break;
+             }
+             this->config_failures_ = 0;
+             this->read_device_state_(CommandStep::SESSION_STATE_READ);
+             break;
+         case CommandStep::SESSION_STATE_READ:
+             this->session_state_read_();
+             break;
+         case CommandStep::SESSION_CONFIGURED: {
+             if (!success || this->config_failures_ > 0) {
+                 ESP_LOGE(TAG, "%s: One or more runtime configuration commands failed", ERROR_CONFIGURATION);
+             }
+             // The radar now differs from the YAML; re-apply the YAML at the next boot
+             StoredConfig invalid{};
+             this->config_pref_.save(&invalid);
+             break;
+         }
+ #ifdef HLK_LD2410S_CALIBRATION
+         case CommandStep::CALIBRATION_CONFIG_MODE:
+             if (!success) {
+                 ESP_LOGE(TAG, "%s: Failed to enable configuration mode for calibration", ERROR_CONFIGURATION);
+                 break;
+             }
+             if (!this->output_mode_) {
+                 this->queue_command_(CommandWord::SWITCH_OUTPUT_MODE, {0x01}, CommandStep::OUTPUT_MODE_WRITTEN);
+             }
+             this->disable_configuration_(CommandStep::CALIBRATION_STARTED);
+             break;
+         case CommandStep::CALIBRATION_STARTED:
+             if (!success) {
+                 ESP_LOGE(TAG, "%s: Failed to disable configuration mode for calibration", ERROR_CONFIGURATION);
+                 break;
+             }
+             ESP_LOGI(TAG, "Calibrating for %ums, keep the room empty", this->calibration_duration_);
+             this->calibration_.start(millis(), this->calibration_duration_);
+             break;
+         case CommandStep::CALIBRATION_RESULT:
+             if (!success) {
+                 ESP_LOGE(TAG, "%s: Failed to enable configuration mode for calibration", ERROR_CONFIGURATION);
+                 break;
+             }
+             if (command.context != 0) {
+                 this->set_trigger_thresholds_();
+                 this->set_hold_thresholds_();
+                 // The radar no longer matches the YAML thresholds; re-apply them at the next boot
+                 StoredConfig invalid{};
+                 this->config_pref_.save(&invalid);
+             }
+             if (!this->output_mode_) {
+                 this->set_output_mode_();
+             }
+             this->disable_configuration_();
+             break;
+ #else
+         case CommandStep::CALIBRATION_CONFIG_MODE:
+         case CommandStep::CALIBRATION_STARTED:
+         case CommandStep::CALIBRATION_RESULT:
+             break;
+ #endif
+         case CommandStep::PARAMETERS_READ:
+             // One 32-bit value per requested id, in request order
+             if (!success || length != MIRRORED_PARAMETER_COUNT * sizeof(uint32_t)) {
+                 ESP_LOGD(TAG, "Radar did not report its parameters, writing all of them");
+             } else {
+                 for (uint8_t i = 0; i < MIRRORED_PARAMETER_COUNT; i++) {
+                     const uint32_t value = Field<0, uint32_t>::read(data + i * sizeof(uint32_t));
+                     this->device_mirror_.set(MIRRORED_PARAMETERS[i], value);
+                     ESP_LOGD(TAG, "Radar reports %s = %u", parameter_name(MIRRORED_PARAMETERS[i]), value);
+                 }
+             }
+             this->continue_with_(static_cast<CommandStep>(command.context));
+             break;
+ #ifdef HLK_LD2410S_THRESHOLDS
+         case CommandStep::TRIGGER_THRESHOLDS_READ:
+             if (success && length == MAX_GATES) {
+                 this->device_mirror_.set_trigger_thresholds(data);
+             }
+             break;
+         case CommandStep::HOLD_THRESHOLDS_READ:
+             if (success && length == MAX_GATES) {
+                 this->device_mirror_.set_hold_thresholds(data);
+             }
+             this->continue_with_(static_cast<CommandStep>(command.context));
+             break;
+ #endif
+         case CommandStep::OUTPUT_MODE_WRITTEN:
+         case CommandStep::AUTO_THRESHOLD_WRITTEN:
+             if (!success) {
+                 ESP_LOGE(TAG, "%s: Failed to set %s", ERROR_CONFIGURATION,
+                          command.step == CommandStep::OUTPUT_MODE_WRITTEN ? "output mode" : "auto threshold");
+                 this->config_failures_++;
+             }
+             break;
+         case CommandStep::PARAMETERS_WRITTEN: {
+             // The ACK carries one status byte per parameter, in the order written
+             const size_t count = command.payload_length / ParameterEntryLayout::SIZE;
+             for (size_t i = 0; i < count; i++) {
+                 const uint8_t *entry = command.payload.data() + i * ParameterEntryLayout::SIZE;
+                 const ParameterId id = static_cast<ParameterId>(ParameterEntryLayout::Id::read(entry));
+                 const bool written = length >= count ? data[i] == static_cast<uint8_t>(ResponseStatus::SUCCESS) : success;
+                 if (!written) {
+                     ESP_LOGE(TAG, "%s: Failed to set %s", ERROR_CONFIGURATION, parameter_name(id));
+                     this->config_failures_++;
+                     continue;
+                 }
+                 this->device_mirror_.set(id, ParameterEntryLayout::Value::read(entry));
+             }
+             break;
          }
+ #ifdef HLK_LD2410S_THRESHOLDS
+         case CommandStep::TRIGGER_THRESHOLDS_WRITTEN:
+             if (!success) {
+                 ESP_LOGE(TAG, "%s: Failed to set trigger thresholds", ERROR_CONFIGURATION);
+                 this->config_failures_++;
+                 break;
+             }
+             // The mirror takes what was sent, not what is configured by now
+             this->device_mirror_.set_trigger_thresholds(command.payload.data());
+             break;
+         case CommandStep::HOLD_THRESHOLDS_WRITTEN:
+             if (!success) {
+                 ESP_LOGE(TAG, "%s: Failed to set hold thresholds", ERROR_CONFIGURATION);
+                 this->config_failures_++;
+                 break;
+             }
+             this->device_mirror_.set_hold_thresholds(command.payload.data());
+             break;
+ #else
+         case CommandStep::TRIGGER_THRESHOLDS_READ:
+         case CommandStep::HOLD_THRESHOLDS_READ:
+         case CommandStep::TRIGGER_THRESHOLDS_WRITTEN:
+         case CommandStep::HOLD_THRESHOLDS_WRITTEN:
+             break;
+ #endif
      }
+ }
  
-     uint16_t length = data[4] | (data[5] << 8);
-     if (length + 7 != data.size()) {
-         ESP_LOGW(TAG, "%s: Invalid response length", ERROR_VALIDATION);
-         return false;
+ void HLKLD2410SComponent::continue_with_(CommandStep step) {
+     // Continuations of read_device_state_() only need to know that the reads are done
+     PendingCommand done;
+     done.step = step;
+     this->handle_result_(done, true, nullptr, 0);
+ }
+ 
+ void HLKLD2410SComponent::handle_ack_(const uint8_t *data, size_t length) {
+     if (!this->validate_response_(data, length)) {
+         this->link_stats_.failed_responses++;
+         this->record_(RecordKind::REJECTED, ByteView(data, length));
+         return;
      }
+     this->record_(RecordKind::ACK, ByteView(data, length));
  
-     std::vector<uint8_t> check_data(data.begin(), data.end() - 1);
-     if (data.back() != this->calculate_checksum_(check_data)) {
-         ESP_LOGW(TAG, "%s: Invalid response checksum", ERROR_VALIDATION);
-         return false;
+     const uint8_t cmd = ConfigFrame::AckCommand::read(data);
+     if (this->command_queue_.empty() || !this->command_queue_.front().in_flight ||
+         static_cast<uint8_t>(this->command_queue_.front().cmd) != cmd) {
+         ESP_LOGW(TAG, "%s: Unexpected ACK for command 0x%02X", ERROR_VALIDATION, cmd);
+         return;
      }
  
-     ResponseStatus status = static_cast<ResponseStatus>(data[6]);
+     this->ack_latency_.record(millis() - this->command_queue_.front().sent_at);
+ 
+     ResponseStatus status = static_cast<ResponseStatus>(ConfigFrame::Status::read(data));
      if (status != ResponseStatus::SUCCESS) {
-         ESP_LOGW(TAG, "%s: Command failed with status 0x%02X", ERROR_VALIDATION, static_cast<uint8_t>(status));
-         return false;
+         this->link_stats_.failed_responses++;
+         ESP_LOGW(TAG, "%s: Command 0x%02X failed with status 0x%02X", ERROR_VALIDATION, cmd,
+                  static_cast<uint8_t>(status));
      }
+     this->complete_command_(status == ResponseStatus::SUCCESS, data + ConfigFrame::ACK_DATA,
+                             length - ConfigFrame::ACK_MIN_LENGTH);
+ }
  
+ bool HLKLD2410SComponent::send_command_(const PendingCommand &command) {
+     CommandFrame<MAX_COMMAND_PAYLOAD> frame;
+     if (!frame.encode(command.cmd, ByteView(command.payload.data(), command.payload_length)) ||
+         !this->write_array_(frame.data(), frame.size())) {
+         ESP_LOGE(TAG, "%s: Failed to send command 0x%02X", ERROR_COMMUNICATION, static_cast<uint8_t>(command.cmd));
+         return false;
+     }
+     this->record_(RecordKind::COMMAND, ByteView(frame.data(), frame.size()));
      return true;
  }
  
- uint8_t HLKLD2410SComponent::calculate_checksum_(const std::vector<uint8_t> &data) {
-     uint8_t sum = 0;
-     for (uint8_t byte : data) {
-         sum += byte;
+ bool HLKLD2410SComponent::validate_response_(const uint8_t *data, size_t length) {
+     switch (check_config_frame(data, length)) {
+         case ConfigFrameError::NONE:
+             return true;
+         case ConfigFrameError::TOO_SHORT:
+             ESP_LOGW(TAG, "%s: Response too short", ERROR_VALIDATION);
+             break;
+         case ConfigFrameError::BAD_HEADER:
+             ESP_LOGW(TAG, "%s: Invalid response header", ERROR_VALIDATION);
+             break;
+         case ConfigFrameError::BAD_LENGTH:
+             ESP_LOGW(TAG, "%s: Invalid response length", ERROR_VALIDATION);
+             break;
+         case ConfigFrameError::BAD_CHECKSUM:
+             ESP_LOGW(TAG, "%s: Invalid response checksum", ERROR_VALIDATION);
+             break;
      }
-     return sum;
+     return false;
+ }
+ 
+ uint8_t HLKLD2410SComponent::calculate_checksum_(const uint8_t *data, size_t length) {
+     return config_checksum(data, length);
  }
  
- bool HLKLD2410SComponent::set_output_mode_() {
-     return this->send_command_(CommandWord::SWITCH_OUTPUT_MODE, {static_cast<uint8_t>(this->output_mode_ ? 0x01 : 0x00)});
+ void HLKLD2410SComponent::set_output_mode_() {
+     this->queue_command_(CommandWord::SWITCH_OUTPUT_MODE, {static_cast<uint8_t>(this->output_mode_ ? 0x01 : 0x00)},
+                          CommandStep::OUTPUT_MODE_WRITTEN);
  }
  
- bool HLKLD2410SComponent::set_response_speed_() {
-     return this->send_command_(CommandWord::WRITE_PARAMETERS, {this->response_speed_});
+ void HLKLD2410SComponent::set_response_speed_() {
+     this->pending_parameters_.add(ParameterId::RESPONSE_SPEED, this->response_speed_);
  }
  
- bool HLKLD2410SComponent::set_unmanned_delay_() {
-     return this->send_command_(CommandWord::WRITE_PARAMETERS, {this->unmanned_delay_});
+ void HLKLD2410SComponent::set_unmanned_delay_() {
+     this->pending_parameters_.add(ParameterId::UNMANNED_DELAY, this->unmanned_delay_);
  }
  
- bool HLKLD2410SComponent::set_status_report_frequency_() {
-     return this->send_command_(CommandWord::WRITE_PARAMETERS, {static_cast<uint8_t>(this->status_report_frequency_ * 10)});
+ void HLKLD2410SComponent::set_status_report_frequency_() {
+     this->pending_parameters_.add(ParameterId::STATUS_REPORT_FREQUENCY,
+                                   report_frequency_value(this->status_report_frequency_));
  }
  
- bool HLKLD2410SComponent::set_distance_report_frequency_() {
-     return this->send_command_(CommandWord::WRITE_PARAMETERS, {static_cast<uint8_t>(this->distance_report_frequency_ * 10)});
+ void HLKLD2410SComponent::set_distance_report_frequency_() {
+     this->pending_parameters_.add(ParameterId::DISTANCE_REPORT_FREQUENCY,
+                                   report_frequency_value(this->distance_report_frequency_));
  }
  
- bool HLKLD2410SComponent::set_auto_threshold_() {
-     return this->send_command_(CommandWord::AUTO_THRESHOLD, {
+ void HLKLD2410SComponent::set_auto_threshold_() {
+     this->queue_command_(CommandWord::AUTO_THRESHOLD, {
          this->trigger_factor_,
          this->hold_factor_,
          this->scan_time_,
          0
-     });
+     }, CommandStep::AUTO_THRESHOLD_WRITTEN);
  }
  
- bool HLKLD2410SComponent::set_farthest_gate_() {
-     return this->send_command_(CommandWord::WRITE_PARAMETERS, {this->farthest_gate_});
+ void HLKLD2410SComponent::set_farthest_gate_() {
+     this->pending_parameters_.add(ParameterId::FARTHEST_GATE, this->farthest_gate_);
  }
  
- bool HLKLD2410SComponent::set_nearest_gate_() {
-     return this->send_command_(CommandWord::WRITE_PARAMETERS, {this->nearest_gate_});
+ void HLKLD2410SComponent::set_nearest_gate_() {
+     this->pending_parameters_.add(ParameterId::NEAREST_GATE, this->nearest_gate_);
  }
  
- bool HLKLD2410SComponent::set_trigger_thresholds_() {
-     return this->send_command_(CommandWord::WRITE_TRIGGER_THRESHOLD, this->trigger_thresholds_);
+ void HLKLD2410SComponent::flush_parameters_() {
+     // Values the radar is known to hold already are not written again
+     ParameterSet parameters;
+     for (size_t i = 0; i < this->pending_parameters_.size(); i++) {
+         const ParameterEntry &entry = this->pending_parameters_[i];
+         if (this->force_reconfigure_ || !this->device_mirror_.matches(entry.id, entry.value)) {
+             parameters.add(entry.id, entry.value);
+         }
+     }
+     if (parameters.size() < this->pending_parameters_.size()) {
+         ESP_LOGD(TAG, "Skipping %u parameters the radar already holds",
+                  static_cast<unsigned>(this->pending_parameters_.size() - parameters.size()));
+     }
+     this->pending_parameters_.clear();
+ 
+     for (size_t offset = 0; offset < parameters.size(); offset += MAX_PARAMETERS_PER_FRAME) {
+         uint8_t payload[MAX_COMMAND_PAYLOAD];
+         const size_t count = parameters.encode(offset, payload);
+         this->queue_command_(CommandWord::WRITE_PARAMETERS, ByteView(payload, count * ParameterEntryLayout::SIZE),
+                              CommandStep::PARAMETERS_WRITTEN);
+     }
  }
  
- bool HLKLD2410SComponent::set_hold_thresholds_() {
-     return this->send_command_(CommandWord::WRITE_HOLD_THRESHOLD, this->hold_thresholds_);
+ #ifdef HLK_LD2410S_THRESHOLDS
+ void HLKLD2410SComponent::set_trigger_thresholds_() {
+     if (!this->force_reconfigure_ && this->device_mirror_.has_trigger_thresholds() &&
+         this->device_mirror_.trigger_thresholds() == this->trigger_thresholds_) {
+         ESP_LOGD(TAG, "Radar already holds these trigger thresholds");
+         return;
+     }
+     this->queue_command_(CommandWord::WRITE_TRIGGER_THRESHOLD, this->trigger_thresholds_,
+                          CommandStep::TRIGGER_THRESHOLDS_WRITTEN);
+ }
+ 
+ void HLKLD2410SComponent::set_hold_thresholds_() {
+     if (!this->force_reconfigure_ && this->device_mirror_.has_hold_thresholds() &&
+         this->device_mirror_.hold_thresholds() == this->hold_thresholds_) {
+         ESP_LOGD(TAG, "Radar already holds these hold thresholds");
+         return;
+     }
+     this->queue_command_(CommandWord::WRITE_HOLD_THRESHOLD, this->hold_thresholds_,
+                          CommandStep::HOLD_THRESHOLDS_WRITTEN);
  }
+ #endif
  
  }  // namespace hlk_ld2410s
  }  // namespace esphome
\ No newline at end of file
@@ -6,13 +6,62 @@
  */
 
  #pragma once
-
+ 
  #include "esphome/core/component.h"
  #include "esphome/core/helpers.h"
+ #include "esphome/core/preferences.h"
  #include "esphome/components/uart/uart.h"
  #include "esphome/components/sensor/sensor.h"
  #include "esphome/components/binary_sensor/binary_sensor.h"
  #include "esphome/components/button/button.h"
+ #ifdef HLK_LD2410S_CONTROLS
+ #include "esphome/components/number/number.h"
+ #include "esphome/components/select/select.h"
+ #endif
+ #ifdef HLK_LD2410S_FIRMWARE_SENSOR
+ #include "esphome/components/text_sensor/text_sensor.h"
+ #endif
+ #include "adaptive_report.h"
+ #include "aggregation.h"
+ #include "calibration.h"
+ #include "diagnostics.h"
+ #include "distance_filter.h"
+ #include "flight_recorder.h"
+ #include "frame_parser.h"
+ #include "frame_queue.h"
+ #include "trace.h"
+ #include "zones.h"
+ 
+ #include <algorithm>
+ #include <array>
+ #include <cmath>
+ #include <initializer_list>
+ 
+ /**
+  * Feature switches emitted by __init__.py from the YAML of every radar on the node:
+  *   HLK_LD2410S_ENGINEERING    engineering frame decoding
+  *   HLK_LD2410S_GATE_SENSORS   number of gate energy sensor slots (highest gate in use + 1)
+  *   HLK_LD2410S_THRESHOLDS     per-gate threshold tables
+  *   HLK_LD2410S_CALIBRATION    empty-room calibration
+  *   HLK_LD2410S_ZONES          number of zone slots (most zones on one radar)
+  *   HLK_LD2410S_ADAPTIVE_REPORT  presence-driven report frequency
+  * Whatever no radar uses is compiled out.
+  */
+ #if defined(HLK_LD2410S_GATE_SENSORS) && HLK_LD2410S_GATE_SENSORS > 16
+ #error "HLK_LD2410S_GATE_SENSORS exceeds the 16 radar gates"
+ #endif
+ #if defined(HLK_LD2410S_ZONES) && HLK_LD2410S_ZONES > 8
+ #error "HLK_LD2410S_ZONES exceeds MAX_ZONES"
+ #endif
+ // Gate sensors and zones share the energy publish window
+ #if defined(HLK_LD2410S_GATE_SENSORS) || defined(HLK_LD2410S_ZONES)
+ #define HLK_LD2410S_ENERGY_WINDOW
+ #endif
+ 
+ #ifdef HLK_LD2410S_RX_TASK
+ #include <freertos/FreeRTOS.h>
+ #include <freertos/task.h>
+ #endif
  
  namespace esphome {
  namespace hlk_ld2410s {
@@ -23,13 +72,27 @@
  static const char *const ERROR_TIMEOUT = "Timeout Error";
  static const char *const ERROR_CONFIGURATION = "Configuration Error";
  
- static const uint8_t DATA_FRAME_HEADER[4] = {0xF4, 0xF3, 0xF2, 0xF1};
- static const uint8_t CONFIG_FRAME_HEADER[4] = {0xFD, 0xFC, 0xFB, 0xFA};
- static const uint8_t DATA_FRAME_MIN_LENGTH = 4;
- static const uint8_t CONFIG_FRAME_MIN_LENGTH = 7;
- static const uint8_t DATA_FRAME_ENGINEERING_LENGTH = 22;
- static const uint8_t DATA_FRAME_SIMPLE_LENGTH = 4;
- static const uint8_t MAX_GATES = 16;
+ static const uint8_t MAX_QUEUED_COMMANDS = 16;
+ // Per-instance read budget per loop(); comfortably above what 115200 baud delivers
+ // between two loops, so several radars on one node each get their turn
+ static const uint16_t MAX_BYTES_PER_LOOP = 256;
+ // Bytes fetched per read_array() call; lives on the stack in loop()
+ static const uint8_t RX_CHUNK_SIZE = 64;
+ // Dump bytes per log line; 48 bytes become 64 base64 characters
+ static const uint8_t RECORDER_LINE_BYTES = 48;
+ 
+ #ifdef HLK_LD2410S_RX_TASK
+ static const uint32_t RX_TASK_STACK_SIZE = 4096;
+ static const uint8_t RX_TASK_PRIORITY = 5;
+ static const uint32_t RX_TASK_POLL_INTERVAL = 2;
+ #endif
+ static const uint32_t COMMAND_TIMEOUT = 1000;
+ static const uint8_t COMMAND_RETRIES = 2;
+ #ifdef HLK_LD2410S_ADAPTIVE_REPORT
+ // Pause before writing an adaptive report frequency again after a failed write
+ static const uint32_t ADAPTIVE_REPORT_RETRY_INTERVAL = 5000;
+ #endif
+ static const uint8_t MAX_PARAMETERS = 8;
  static const uint8_t MIN_RESPONSE_SPEED = 5;
  static const uint8_t MAX_RESPONSE_SPEED = 10;
  static const uint8_t MIN_UNMANNED_DELAY = 10;
@@ -47,26 +110,32 @@
  static const uint8_t MIN_SCAN_TIME = 10;
  static const uint8_t MAX_SCAN_TIME = 250;
  
- enum class CommandWord : uint8_t {
-     ENABLE_CONFIGURATION = 0x04,
-     DISABLE_CONFIGURATION = 0x05,
-     READ_FIRMWARE_VERSION = 0x06,
-     WRITE_PARAMETERS = 0x07,
-     READ_PARAMETERS = 0x08,
-     SWITCH_OUTPUT_MODE = 0x0A,
-     RESTART = 0x0B,
-     RESTORE_FACTORY_SETTINGS = 0x0C,
-     READ_TRIGGER_THRESHOLD = 0x0D,
-     WRITE_TRIGGER_THRESHOLD = 0x0E,
-     READ_HOLD_THRESHOLD = 0x0F,
-     WRITE_HOLD_THRESHOLD = 0x10,
-     AUTO_THRESHOLD = 0x11,
+ enum class ParameterId : uint16_t {
+     STATUS_REPORT_FREQUENCY = 0x02,
+     FARTHEST_GATE = 0x05,
+     UNMANNED_DELAY = 0x06,
+     NEAREST_GATE = 0x0A,
+     RESPONSE_SPEED = 0x0B,
+     DISTANCE_REPORT_FREQUENCY = 0x0C,
  };
  
- enum class ResponseStatus : uint8_t {
-     SUCCESS = 0x01,
-     FAILURE = 0x02,
-     COMMAND_ERROR = 0x03,
+ // Runtime-tunable parameters exposed as number entities
+ enum class Control : uint8_t {
+     UNMANNED_DELAY = 0,
+     STATUS_REPORT_FREQUENCY,
+     DISTANCE_REPORT_FREQUENCY,
+     FARTHEST_GATE,
+     NEAREST_GATE,
+     COUNT,
+ };
+ 
+ static const uint8_t CONTROL_COUNT = static_cast<uint8_t>(Control::COUNT);
+ 
+ // Changes waiting for the next runtime configuration session, besides pending parameters
+ enum ConfigChange : uint8_t {
+     CHANGE_OUTPUT_MODE = 1 << 0,
+     CHANGE_TRIGGER_THRESHOLDS = 1 << 1,
+     CHANGE_HOLD_THRESHOLDS = 1 << 2,
  };
  
  enum class CommandType : uint8_t {
@@ -74,14 +143,196 @@
      CMD_SIMPLE_DATA = 0x02,
  };
  
+ // What happens when a queued command completes, see handle_result_(). Steps
+ // replace per-command closures so queuing a command never allocates.
+ enum class CommandStep : uint8_t {
+     NONE = 0,
+     BOOT_CONFIG_MODE,            // boot session entered configuration mode
+     BOOT_FIRMWARE_VERSION,       // firmware version read at boot
+     BOOT_STATE_READ,             // radar state read at boot, decide what to write
+     BOOT_CONFIGURED,             // boot session left configuration mode
+     SESSION_CONFIG_MODE,         // runtime session entered configuration mode
+     SESSION_STATE_READ,          // radar state read, write the runtime changes
+     SESSION_CONFIGURED,          // runtime session left configuration mode
+     CALIBRATION_CONFIG_MODE,     // switch to engineering output for the scan
+     CALIBRATION_STARTED,         // configuration mode left, start collecting
+     CALIBRATION_RESULT,          // context: 1 if thresholds are to be written
+     PARAMETERS_READ,             // context: step to continue with if this is the last read
+     TRIGGER_THRESHOLDS_READ,
+     HOLD_THRESHOLDS_READ,        // context: step to continue with
+     OUTPUT_MODE_WRITTEN,
+     AUTO_THRESHOLD_WRITTEN,
+     PARAMETERS_WRITTEN,
+     TRIGGER_THRESHOLDS_WRITTEN,
+     HOLD_THRESHOLDS_WRITTEN,
+ };
+ 
+ const char *parameter_name(ParameterId id);
+ // Report frequencies are sent in tenths of a Hz, rounded so 0.3 Hz is 3 and not 2
+ uint32_t report_frequency_value(float frequency);
+ 
+ static const uint32_t FNV1A_OFFSET = 2166136261UL;
+ // FNV-1a over a byte range; pass the previous result to chain ranges
+ uint32_t fnv1a_hash(const uint8_t *data, size_t length, uint32_t hash = FNV1A_OFFSET);
+ 
+ // Persisted after a fully successful configuration session
+ struct StoredConfig {
+     uint32_t config_hash;
+     uint32_t firmware_hash;
+ };
+ 
+ struct ParameterEntry {
+     ParameterId id;
+     uint32_t value;
+ };
+ 
+ // Collects (parameter id, value) pairs so they can be written in as few
+ // WRITE_PARAMETERS frames as possible. Adding an id twice keeps the last value.
+ class ParameterSet {
+  public:
+     bool add(ParameterId id, uint32_t value);
+     void clear() { count_ = 0; }
+     bool empty() const { return count_ == 0; }
+     size_t size() const { return count_; }
+     const ParameterEntry &operator[](size_t index) const { return entries_[index]; }
+     // Encodes up to MAX_PARAMETERS_PER_FRAME entries starting at offset into payload,
+     // which must hold MAX_COMMAND_PAYLOAD bytes; returns how many were encoded
+     size_t encode(size_t offset, uint8_t *payload) const;
+ 
+  protected:
+     ParameterEntry entries_[MAX_PARAMETERS];
+     size_t count_{0};
+ };
+ 
+ // Parameters read back into the device mirror, in READ_PARAMETERS order
+ static const ParameterId MIRRORED_PARAMETERS[] = {
+     ParameterId::STATUS_REPORT_FREQUENCY,
+     ParameterId::FARTHEST_GATE,
+     ParameterId::UNMANNED_DELAY,
+     ParameterId::NEAREST_GATE,
+     ParameterId::RESPONSE_SPEED,
+     ParameterId::DISTANCE_REPORT_FREQUENCY,
+ };
+ static const uint8_t MIRRORED_PARAMETER_COUNT = sizeof(MIRRORED_PARAMETERS) / sizeof(MIRRORED_PARAMETERS[0]);
+ 
+ /**
+  * What the radar itself reported at the start of the last configuration
+  * session, kept current as writes are acknowledged. Writes are limited to
+  * values that differ from it. Anything the radar did not report is unknown
+  * and never matches, so firmware without the read commands gets every write.
+  */
+ class DeviceMirror {
+  public:
+     void clear();
+     void set(ParameterId id, uint32_t value);
+     bool has(ParameterId id) const;
+     uint32_t get(ParameterId id) const;
+     // Known to hold value already, so writing it can be skipped
+     bool matches(ParameterId id, uint32_t value) const { return has(id) && get(id) == value; }
+     // Known to hold something else
+     bool differs(ParameterId id, uint32_t value) const { return has(id) && get(id) != value; }
+ #ifdef HLK_LD2410S_THRESHOLDS
+     void set_trigger_thresholds(const uint8_t *thresholds);
+     void set_hold_thresholds(const uint8_t *thresholds);
+     bool has_trigger_thresholds() const { return has_trigger_thresholds_; }
+     bool has_hold_thresholds() const { return has_hold_thresholds_; }
+     const std::array<uint8_t, MAX_GATES> &trigger_thresholds() const { return trigger_thresholds_; }
+     const std::array<uint8_t, MAX_GATES> &hold_thresholds() const { return hold_thresholds_; }
+ #endif
+ 
+  protected:
+     static int index_(ParameterId id);
+ 
+     std::array<uint32_t, MIRRORED_PARAMETER_COUNT> values_{};
+     uint8_t known_{0};  // one bit per MIRRORED_PARAMETERS entry
+ #ifdef HLK_LD2410S_THRESHOLDS
+     std::array<uint8_t, MAX_GATES> trigger_thresholds_{};
+     std::array<uint8_t, MAX_GATES> hold_thresholds_{};
+     bool has_trigger_thresholds_{false};
+     bool has_hold_thresholds_{false};
+ #endif
+ };
+ 
+ struct PendingCommand {
+     CommandWord cmd;
+     std::array<uint8_t, MAX_COMMAND_PAYLOAD> payload;
+     uint8_t payload_length{0};
+     CommandStep step{CommandStep::NONE};
+     uint32_t context{0};  // step specific, see CommandStep
+     uint32_t timeout{COMMAND_TIMEOUT};
+     uint32_t sent_at{0};
+     uint8_t retries{COMMAND_RETRIES};
+     bool in_flight{false};
+ };
+ 
+ // Fixed ring of MAX_QUEUED_COMMANDS commands; the front one is sent first
+ class CommandQueue {
+  public:
+     bool empty() const { return count_ == 0; }
+     bool full() const { return count_ == MAX_QUEUED_COMMANDS; }
+     size_t size() const { return count_; }
+     PendingCommand &front() { return slots_[head_]; }
+     const PendingCommand &front() const { return slots_[head_]; }
+     // Callers check full() first
+     void push(const PendingCommand &command) {
+         slots_[(head_ + count_) % MAX_QUEUED_COMMANDS] = command;
+         count_++;
+     }
+     void pop() {
+         head_ = (head_ + 1) % MAX_QUEUED_COMMANDS;
+         count_--;
+     }
+ 
+  protected:
+     std::array<PendingCommand, MAX_QUEUED_COMMANDS> slots_;
+     uint8_t head_{0};
+     uint8_t count_{0};
+ };
+ 
+ // Newest decoded radar state; frames overwrite it, publishing reads it
+ struct RadarState {
+     bool valid{false};
+     bool presence{false};
+     uint16_t distance{0};
+ #ifdef HLK_LD2410S_ENERGY_WINDOW
+     bool has_gate_energy{false};
+ #endif
+ #ifdef HLK_LD2410S_GATE_SENSORS
+     uint8_t gate_energy[HLK_LD2410S_GATE_SENSORS]{};
+ #endif
+ };
+ 
+ // Per-entity publish limiter: minimum interval, change/deadband filter and
+ // a max-silence heartbeat that republishes unchanged values.
+ struct PublishGate {
+     bool should_publish(float value, uint32_t now, uint32_t interval, float deadband, uint32_t max_silence);
+     // True if value differs from the last publish, or nothing was published yet
+     bool changed(float value) const { return !this->published || value != this->last_value; }
+     void mark_published(float value, uint32_t now) {
+         this->published = true;
+         this->last_publish = now;
+         this->last_value = value;
+     }
+ 
+     uint32_t last_publish{0};
+     float last_value{0.0f};
+     bool published{false};
+ };
+ 
  class EnableConfigButton;
  class DisableConfigButton;
+ class CalibrateButton;
+ #ifdef HLK_LD2410S_CONTROLS
+ class ControlNumber;
+ class OutputModeSelect;
+ class ResponseSpeedSelect;
+ #endif
  
  class HLKLD2410SComponent : public Component, public uart::UARTDevice {
   public:
      // Default constructor for ESPHome registration
      HLKLD2410SComponent() = default;
-     
+ 
      // Constructor with UART parent
      explicit HLKLD2410SComponent(uart::UARTComponent *parent) : uart::UARTDevice(parent) {}
  
@@ -96,10 +347,71 @@
      void set_distance_sensor(sensor::Sensor *distance_sensor) { distance_sensor_ = distance_sensor; }
      void set_presence_sensor(binary_sensor::BinarySensor *presence_sensor) { presence_sensor_ = presence_sensor; }
      void set_config_mode_sensor(binary_sensor::BinarySensor *config_mode_sensor) { config_mode_sensor_ = config_mode_sensor; }
+ #ifdef HLK_LD2410S_FIRMWARE_SENSOR
+     void set_firmware_version_sensor(text_sensor::TextSensor *firmware_version_sensor) {
+         firmware_version_sensor_ = firmware_version_sensor;
+     }
+ #endif
      void set_enable_config_button(EnableConfigButton *enable_config_button) { enable_config_button_ = enable_config_button; }
      void set_disable_config_button(DisableConfigButton *disable_config_button) { disable_config_button_ = disable_config_button; }
-     void set_gate_energy_sensor(uint8_t gate, sensor::Sensor *gate_energy_sensor) { gate_energy_sensors_[gate] = gate_energy_sensor; }
+ #ifdef HLK_LD2410S_CALIBRATION
+     void set_calibrate_button(CalibrateButton *calibrate_button) { calibrate_button_ = calibrate_button; }
+     void set_calibration_duration(uint32_t calibration_duration) { calibration_duration_ = calibration_duration; }
+     void set_calibration_sigma(float trigger_sigma, float hold_sigma) {
+         trigger_sigma_ = trigger_sigma;
+         hold_sigma_ = hold_sigma;
+     }
+     void set_trigger_threshold_sensor(uint8_t gate, sensor::Sensor *threshold_sensor) { trigger_threshold_sensors_[gate] = threshold_sensor; }
+     void set_hold_threshold_sensor(uint8_t gate, sensor::Sensor *threshold_sensor) { hold_threshold_sensors_[gate] = threshold_sensor; }
+ #endif
+ #ifdef HLK_LD2410S_GATE_SENSORS
+     void set_gate_energy_sensor(uint8_t gate, sensor::Sensor *gate_energy_sensor,
+                                 GateAggregate aggregate = GateAggregate::MEAN) {
+         gate_energy_sensors_[gate] = gate_energy_sensor;
+         gate_energy_aggregates_[gate] = aggregate;
+     }
+ #endif
+ #ifdef HLK_LD2410S_ZONES
+     void add_zone(uint8_t first_gate, uint8_t last_gate, uint8_t trigger, uint8_t hold) {
+         zones_[zone_count_++].configure(first_gate, last_gate, trigger, hold);
+     }
+     void set_zone_occupancy_sensor(uint8_t zone, binary_sensor::BinarySensor *occupancy_sensor) {
+         zone_occupancy_sensors_[zone] = occupancy_sensor;
+     }
+     void set_zone_energy_sensor(uint8_t zone, sensor::Sensor *energy_sensor, GateAggregate aggregate = GateAggregate::MEAN) {
+         zone_energy_sensors_[zone] = energy_sensor;
+         zone_energy_aggregates_[zone] = aggregate;
+     }
+ #endif
+ #ifdef HLK_LD2410S_ENERGY_WINDOW
+     void set_gate_energy_window(uint32_t gate_energy_window) { gate_energy_window_ = gate_energy_window; }
+ #endif
      void set_throttle(uint32_t throttle) { throttle_ = throttle; }
+     void set_distance_deadband(float distance_deadband) { distance_deadband_ = distance_deadband; }
+     void set_max_silence(uint32_t max_silence) { max_silence_ = max_silence; }
+     void set_distance_median_filter(uint8_t window) { distance_filter_.set_median(window); }
+     void set_distance_ema_filter(uint16_t alpha) { distance_filter_.set_ema(alpha); }
+     void set_distance_alpha_beta_filter(uint16_t alpha, uint16_t beta) { distance_filter_.set_alpha_beta(alpha, beta); }
+     void set_diagnostic_sensor(DiagnosticSensor type, sensor::Sensor *diagnostic_sensor) {
+         diagnostic_sensors_[static_cast<uint8_t>(type)] = diagnostic_sensor;
+     }
+     void set_diagnostics_interval(uint32_t diagnostics_interval) { diagnostics_interval_ = diagnostics_interval; }
+     void set_loop_budget(uint32_t loop_budget) { loop_budget_ = loop_budget; }
+ #ifdef HLK_LD2410S_ADAPTIVE_REPORT
+     void set_adaptive_report(float idle_frequency, float active_frequency, uint32_t idle_after) {
+         adaptive_report_.configure(idle_frequency, active_frequency, idle_after);
+     }
+ #endif
+     void set_preference_key(const std::string &key) { preference_key_ = fnv1_hash("hlk_ld2410s_" + key); }
+     void set_force_reconfigure(bool force_reconfigure) { force_reconfigure_ = force_reconfigure; }
+ #ifdef HLK_LD2410S_CONTROLS
+     void set_control_number(Control control, ControlNumber *control_number) {
+         control_numbers_[static_cast<uint8_t>(control)] = control_number;
+     }
+     void set_output_mode_select(OutputModeSelect *output_mode_select) { output_mode_select_ = output_mode_select; }
+     void set_response_speed_select(ResponseSpeedSelect *response_speed_select) { response_speed_select_ = response_speed_select; }
+ #endif
+     void set_config_debounce(uint32_t config_debounce) { config_debounce_ = config_debounce; }
      void set_output_mode(bool output_mode) { output_mode_ = output_mode; }
      void set_response_speed(uint8_t response_speed) { response_speed_ = response_speed; }
      void set_unmanned_delay(uint8_t unmanned_delay) { unmanned_delay_ = unmanned_delay; }
@@ -107,64 +419,227 @@
      void set_distance_report_frequency(float distance_report_frequency) { distance_report_frequency_ = distance_report_frequency; }
      void set_farthest_gate(uint8_t farthest_gate) { farthest_gate_ = farthest_gate; }
      void set_nearest_gate(uint8_t nearest_gate) { nearest_gate_ = nearest_gate; }
-     void set_trigger_thresholds(const std::vector<uint8_t> &trigger_thresholds) { trigger_thresholds_ = trigger_thresholds; }
-     void set_hold_thresholds(const std::vector<uint8_t> &hold_thresholds) { hold_thresholds_ = hold_thresholds; }
+ #ifdef HLK_LD2410S_THRESHOLDS
+     void set_trigger_thresholds(const std::array<uint8_t, MAX_GATES> &trigger_thresholds) {
+         trigger_thresholds_ = trigger_thresholds;
+         has_trigger_thresholds_ = true;
+     }
+     void set_hold_thresholds(const std::array<uint8_t, MAX_GATES> &hold_thresholds) {
+         hold_thresholds_ = hold_thresholds;
+         has_hold_thresholds_ = true;
+     }
+ #endif
      void set_auto_threshold(uint8_t trigger_factor, uint8_t hold_factor, uint8_t scan_time) {
          trigger_factor_ = trigger_factor;
          hold_factor_ = hold_factor;
          scan_time_ = scan_time;
      }
  
+     // Runtime changes; written to the radar in one debounced configuration session
+     bool update_output_mode(bool output_mode);
+     bool update_response_speed(uint8_t response_speed);
+     bool update_control(Control control, float value);
+     // Moves both ends of the detection range; nearest must not be beyond farthest
+     bool update_gate_range(uint8_t nearest, uint8_t farthest);
+ #ifdef HLK_LD2410S_THRESHOLDS
+     bool update_gate_thresholds(uint8_t gate, uint8_t trigger, uint8_t hold);
+ #endif
+ 
+     // Logs the flight recorder contents as base64, see flight_recorder.h for the format
+     void dump_flight_recorder();
+ 
+     // Radar state as read back in the last configuration session, e.g. for verification from a lambda
+     const DeviceMirror &device_mirror() const { return device_mirror_; }
+ 
   protected:
      friend class EnableConfigButton;
      friend class DisableConfigButton;
+     friend class CalibrateButton;
  
-     bool enable_configuration_();
-     bool disable_configuration_();
+     void enable_configuration_(CommandStep step = CommandStep::NONE, uint32_t context = 0);
+     // Enable configuration button; refused while a session is running
+     void enter_configuration_mode_();
+     void disable_configuration_(CommandStep step = CommandStep::NONE, uint32_t context = 0);
      void apply_cached_config_();
+     // Adds every configured parameter in the encoding sent to the radar
+     void stage_parameters_(ParameterSet &parameters) const;
+     bool device_differs_() const;
+     // Queues the reads; the last one continues with then
+     void read_device_state_(CommandStep then);
+     void configure_(const uint8_t *firmware, size_t length);
+     void boot_state_read_();
+     void session_state_read_();
+     void apply_firmware_version_(const uint8_t *firmware, size_t length);
+     void schedule_config_session_();
+     void run_config_session_(uint32_t now);
+ #ifdef HLK_LD2410S_ADAPTIVE_REPORT
+     void adapt_report_frequency_(uint32_t now);
+ #endif
+     void publish_controls_();
+     uint32_t config_hash_() const;
+     void flush_parameters_();
+ #ifdef HLK_LD2410S_CALIBRATION
+     void start_calibration_();
+     void finish_calibration_();
+ #endif
  
      void reset_input_buffer_();
-     bool read_byte_(uint8_t *data, uint32_t timeout = 100);
-     bool read_array_(std::vector<uint8_t> &data, size_t count);
-     bool write_array_(const std::vector<uint8_t> &data);
-     void read_data_();
-     void handle_engineering_data_(const std::vector<uint8_t> &data);
-     void handle_simple_data_(const std::vector<uint8_t> &data);
-     bool send_command_(CommandWord cmd, const std::vector<uint8_t> &payload = {});
-     bool wait_for_ack_(uint32_t timeout = 1000);
-     bool read_ack_();
-     bool validate_response_(const std::vector<uint8_t> &data);
-     uint8_t calculate_checksum_(const std::vector<uint8_t> &data);
- 
-     bool set_output_mode_();
-     bool set_response_speed_();
-     bool set_unmanned_delay_();
-     bool set_status_report_frequency_();
-     bool set_distance_report_frequency_();
-     bool set_auto_threshold_();
-     bool set_farthest_gate_();
-     bool set_nearest_gate_();
-     bool set_trigger_thresholds_();
-     bool set_hold_thresholds_();
+     bool write_array_(const uint8_t *data, size_t length);
+     size_t receive_(uint16_t budget, uint32_t time_budget = UINT32_MAX);
+     void read_data_(const uint8_t *data, size_t length);
+     void dispatch_frame_(FrameType frame, const uint8_t *data, size_t length, uint32_t received_at);
+ #ifdef HLK_LD2410S_RX_TASK
+     static void rx_task_(void *arg);
+ #endif
+ #ifdef HLK_LD2410S_ENGINEERING
+     void handle_engineering_data_(const uint8_t *data, size_t length);
+ #endif
+     void handle_simple_data_(const uint8_t *data, size_t length);
+     void handle_ack_(const uint8_t *data, size_t length);
+     void record_(RecordKind kind, ByteView first, ByteView second = {});
+     void publish_presence_(uint32_t received_at);
+     void publish_state_(uint32_t now);
+ #ifdef HLK_LD2410S_ENERGY_WINDOW
+     void publish_energy_(uint32_t now);
+ #endif
+     void publish_diagnostics_(uint32_t now);
+     void publish_diagnostic_(DiagnosticSensor type, float value);
+ 
+     // Commands are queued and driven from loop(); ACKs are matched by command word
+     void queue_command_(CommandWord cmd, ByteView payload = {}, CommandStep step = CommandStep::NONE,
+                         uint32_t context = 0, uint32_t timeout = COMMAND_TIMEOUT, uint8_t retries = COMMAND_RETRIES);
+     void queue_command_(CommandWord cmd, std::initializer_list<uint8_t> payload, CommandStep step = CommandStep::NONE,
+                         uint32_t context = 0) {
+         this->queue_command_(cmd, ByteView(payload.begin(), payload.size()), step, context);
+     }
+     void process_command_queue_();
+     void complete_command_(bool success, const uint8_t *data, size_t length);
+     // Runs command.step with the ACK status and any data following the echoed command word
+     void handle_result_(const PendingCommand &command, bool success, const uint8_t *data, size_t length);
+     void continue_with_(CommandStep step);
+     bool send_command_(const PendingCommand &command);
+     bool validate_response_(const uint8_t *data, size_t length);
+     uint8_t calculate_checksum_(const uint8_t *data, size_t length);
+ 
+     void set_output_mode_();
+     void set_response_speed_();
+     void set_unmanned_delay_();
+     void set_status_report_frequency_();
+     void set_distance_report_frequency_();
+     void set_auto_threshold_();
+     void set_farthest_gate_();
+     void set_nearest_gate_();
+ #ifdef HLK_LD2410S_THRESHOLDS
+     void set_trigger_thresholds_();
+     void set_hold_thresholds_();
+ #endif
  
      sensor::Sensor *distance_sensor_{nullptr};
      binary_sensor::BinarySensor *presence_sensor_{nullptr};
      binary_sensor::BinarySensor *config_mode_sensor_{nullptr};
+ #ifdef HLK_LD2410S_FIRMWARE_SENSOR
+     text_sensor::TextSensor *firmware_version_sensor_{nullptr};
+ #endif
      EnableConfigButton *enable_config_button_{nullptr};
      DisableConfigButton *disable_config_button_{nullptr};
-     sensor::Sensor *gate_energy_sensors_[MAX_GATES]{nullptr};
+ #ifdef HLK_LD2410S_CONTROLS
+     ControlNumber *control_numbers_[CONTROL_COUNT]{nullptr};
+     OutputModeSelect *output_mode_select_{nullptr};
+     ResponseSpeedSelect *response_speed_select_{nullptr};
+ #endif
+     sensor::Sensor *diagnostic_sensors_[DIAGNOSTIC_SENSOR_COUNT]{nullptr};
+ 
+     FrameParser parser_;
+     uint32_t frame_started_at_{0};  // owned by whoever feeds the parser
+ #ifdef HLK_LD2410S_RX_TASK
+     // The parser and rx_frame_ belong to the receive task once it runs; loop() only pops rx_queue_
+     FrameQueue rx_queue_;
+     ReceivedFrame rx_frame_;
+     ParserStatsSnapshot parser_stats_;  // what loop() publishes instead of parser_.stats()
+     TaskHandle_t rx_task_handle_{nullptr};
+ #endif
+     Tracer tracer_;
+     LinkStats link_stats_;
+ #ifdef HLK_LD2410S_RECORDER_SIZE
+     FlightRecorder<HLK_LD2410S_RECORDER_SIZE> recorder_;
+ #endif
+     LatencyStats ack_latency_;
+     LatencyStats presence_latency_;  // µs from reading a frame to publishing the presence it changed
+     LoopTimeHistogram loop_time_;
+     uint32_t diagnostics_interval_{60000};
+     uint32_t loop_budget_{1000};  // µs of receive and dispatch work per loop()
+     uint32_t last_diagnostics_publish_{0};
+     CommandQueue command_queue_;
+     ParameterSet pending_parameters_;
+     DeviceMirror device_mirror_;
+     uint8_t config_failures_{0};
+     // State a configuration session carries from one command to the next
+     uint32_t boot_config_hash_{0};
+     uint32_t boot_firmware_hash_{0};
+     bool boot_config_stored_{false};
+     uint8_t session_changes_{0};
+     ESPPreferenceObject config_pref_;
+     uint32_t preference_key_{0};
+     bool force_reconfigure_{false};
+     // Probed once at boot; frames are decoded with the tolerant layout until then
+     std::string firmware_version_;
+     const ProtocolVariant *protocol_variant_{&TOLERANT_VARIANT};
+     uint32_t config_debounce_{1000};
+     uint32_t last_config_change_{0};
+     uint8_t config_changes_{0};
+     bool config_session_pending_{false};
+     RadarState radar_state_;
+     DistanceFilter distance_filter_;
+ #ifdef HLK_LD2410S_CALIBRATION
+     CalibrateButton *calibrate_button_{nullptr};
+     sensor::Sensor *trigger_threshold_sensors_[MAX_GATES]{nullptr};
+     sensor::Sensor *hold_threshold_sensors_[MAX_GATES]{nullptr};
+     ThresholdCalibration calibration_;
+     uint32_t calibration_duration_{60000};
+     float trigger_sigma_{3.0f};
+     float hold_sigma_{2.0f};
+ #endif
+     PublishGate distance_publish_;
+     PublishGate presence_publish_;
+ #ifdef HLK_LD2410S_GATE_SENSORS
+     sensor::Sensor *gate_energy_sensors_[HLK_LD2410S_GATE_SENSORS]{nullptr};
+     PublishGate gate_energy_publish_[HLK_LD2410S_GATE_SENSORS];
+     GateWindow gate_energy_windows_[HLK_LD2410S_GATE_SENSORS];
+     GateAggregate gate_energy_aggregates_[HLK_LD2410S_GATE_SENSORS]{};
+ #endif
+ #ifdef HLK_LD2410S_ZONES
+     Zone zones_[HLK_LD2410S_ZONES];
+     uint8_t zone_count_{0};
+     binary_sensor::BinarySensor *zone_occupancy_sensors_[HLK_LD2410S_ZONES]{nullptr};
+     sensor::Sensor *zone_energy_sensors_[HLK_LD2410S_ZONES]{nullptr};
+     PublishGate zone_energy_publish_[HLK_LD2410S_ZONES];
+     GateAggregate zone_energy_aggregates_[HLK_LD2410S_ZONES]{};
+ #endif
+ #ifdef HLK_LD2410S_ENERGY_WINDOW
+     uint32_t gate_energy_window_{10000};
+     uint32_t gate_energy_window_start_{0};
+ #endif
  
-     uint32_t last_update_{0};
      uint32_t throttle_{50};
+     float distance_deadband_{0.0f};
+     uint32_t max_silence_{0};
      bool output_mode_{true};
      uint8_t response_speed_{5};
      uint8_t unmanned_delay_{40};
      float status_report_frequency_{0.5f};
      float distance_report_frequency_{0.5f};
+ #ifdef HLK_LD2410S_ADAPTIVE_REPORT
+     ReportRateController adaptive_report_;
+     uint32_t adaptive_report_written_{0};  // when the last switch was written
+ #endif
      uint8_t farthest_gate_{12};
      uint8_t nearest_gate_{0};
-     std::vector<uint8_t> trigger_thresholds_;
-     std::vector<uint8_t> hold_thresholds_;
+ #ifdef HLK_LD2410S_THRESHOLDS
+     std::array<uint8_t, MAX_GATES> trigger_thresholds_{};
+     std::array<uint8_t, MAX_GATES> hold_thresholds_{};
+     bool has_trigger_thresholds_{false};
+     bool has_hold_thresholds_{false};
+ #endif
      uint8_t trigger_factor_{0};
      uint8_t hold_factor_{0};
      uint8_t scan_time_{0};
@@ -173,7 +648,7 @@
  class EnableConfigButton : public button::Button {
   public:
      explicit EnableConfigButton(HLKLD2410SComponent *parent) : parent_(parent) {}
-     void press_action() override { parent_->enable_configuration_(); }
+     void press_action() override { parent_->enter_configuration_mode_(); }
   protected:
      HLKLD2410SComponent *parent_;
  };
@@ -186,5 +661,54 @@
      HLKLD2410SComponent *parent_;
  };
  
+ #ifdef HLK_LD2410S_CALIBRATION
+ class CalibrateButton : public button::Button {
+  public:
+     explicit CalibrateButton(HLKLD2410SComponent *parent) : parent_(parent) {}
+     void press_action() override { parent_->start_calibration_(); }
+  protected:
+     HLKLD2410SComponent *parent_;
+ };
+ #endif
+ 
+ #ifdef HLK_LD2410S_CONTROLS
+ class ControlNumber : public number::Number {
+  public:
+     ControlNumber(HLKLD2410SComponent *parent, Control control) : parent_(parent), control_(control) {}
+  protected:
+     void control(float value) override {
+         if (parent_->update_control(control_, value)) {
+             this->publish_state(value);
+         }
+     }
+     HLKLD2410SComponent *parent_;
+     Control control_;
+ };
+ 
+ class OutputModeSelect : public select::Select {
+  public:
+     explicit OutputModeSelect(HLKLD2410SComponent *parent) : parent_(parent) {}
+  protected:
+     void control(const std::string &value) override {
+         if (parent_->update_output_mode(value == "Engineering")) {
+             this->publish_state(value);
+         }
+     }
+     HLKLD2410SComponent *parent_;
+ };
+ 
+ class ResponseSpeedSelect : public select::Select {
+  public:
+     explicit ResponseSpeedSelect(HLKLD2410SComponent *parent) : parent_(parent) {}
+  protected:
+     void control(const std::string &value) override {
+         if (parent_->update_response_speed(value == "Fast" ? MAX_RESPONSE_SPEED : MIN_RESPONSE_SPEED)) {
+             this->publish_state(value);
+         }
+     }
+     HLKLD2410SComponent *parent_;
+ };
+ #endif
+ 
  }  // namespace hlk_ld2410s
  }  // namespace esphome
\ No newline at end of file
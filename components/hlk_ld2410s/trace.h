@@ -0,0 +1,132 @@
+/**
+ * Compile-time selectable hot-path tracing for the HLK-LD2410S component.
+ *
+ * The level is set from the `trace` option in YAML:
+ *   off      - every trace point compiles to nothing (default)
+ *   counters - byte/frame counters, summarised once per report interval
+ *   sampled  - counters plus at most one frame/buffer dump per second
+ *   full     - every byte, frame, command and publish is logged
+ *
+ * Hex dumps are formatted into a fixed static buffer, never a std::string.
+ *
+ * Author: mouldybread
+ */
+
+ #pragma once
+ 
+ #include "esphome/core/log.h"
+ #include "diagnostics.h"
+ #include "frame_parser.h"
+ 
+ #define HLK_LD2410S_TRACE_OFF 0
+ #define HLK_LD2410S_TRACE_COUNTERS 1
+ #define HLK_LD2410S_TRACE_SAMPLED 2
+ #define HLK_LD2410S_TRACE_FULL 3
+ 
+ #ifndef HLK_LD2410S_TRACE_LEVEL
+ #define HLK_LD2410S_TRACE_LEVEL HLK_LD2410S_TRACE_OFF
+ #endif
+ 
+ #if HLK_LD2410S_TRACE_LEVEL >= HLK_LD2410S_TRACE_FULL
+ #define HLK_TRACE_FULL(...) ESP_LOGD(TAG, __VA_ARGS__)
+ #else
+ #define HLK_TRACE_FULL(...)
+ #endif
+ 
+ #if HLK_LD2410S_TRACE_LEVEL >= HLK_LD2410S_TRACE_SAMPLED
+ // Logs every call at full level, otherwise only when the tracer's sample window is open
+ #define HLK_TRACE_SAMPLED(tracer, now, ...) \
+     do { \
+         if ((tracer).sample(now)) { \
+             ESP_LOGD(TAG, __VA_ARGS__); \
+         } \
+     } while (0)
+ #else
+ #define HLK_TRACE_SAMPLED(tracer, now, ...)
+ #endif
+ 
+ namespace esphome {
+ namespace hlk_ld2410s {
+ 
+ static const uint32_t TRACE_SAMPLE_INTERVAL = 1000;
+ static const uint32_t TRACE_REPORT_INTERVAL = 10000;
+ 
+ // Space separated hex of up to FRAME_BUFFER_SIZE bytes. Each log statement formats into its own
+ // temporary, HexDump(data, length).c_str(), since the receive task and loop() may trace at once.
+ class HexDump {
+  public:
+     HexDump(const uint8_t *data, size_t length) {
+         static const char DIGITS[] = "0123456789ABCDEF";
+         if (length > FRAME_BUFFER_SIZE) {
+             length = FRAME_BUFFER_SIZE;
+         }
+         char *out = this->buffer_;
+         for (size_t i = 0; i < length; i++) {
+             *out++ = ' ';
+             *out++ = DIGITS[data[i] >> 4];
+             *out++ = DIGITS[data[i] & 0x0F];
+         }
+         *out = '\0';
+     }
+     const char *c_str() const { return this->buffer_; }
+ 
+  protected:
+     char buffer_[FRAME_BUFFER_SIZE * 3 + 1];
+ };
+ 
+ #if HLK_LD2410S_TRACE_LEVEL > HLK_LD2410S_TRACE_OFF
+ class Tracer {
+  public:
+     void count_bytes(size_t count) { this->bytes_ += count; }
+     void count_frame(FrameType frame) {
+         if (frame != FrameType::NONE) {
+             this->frames_[static_cast<uint8_t>(frame)]++;
+         }
+     }
+ 
+     // Opens the sample window at most once per TRACE_SAMPLE_INTERVAL
+     bool sample(uint32_t now) {
+ #if HLK_LD2410S_TRACE_LEVEL >= HLK_LD2410S_TRACE_FULL
+         (void) now;
+         return true;
+ #else
+         if (now - this->last_sample_ < TRACE_SAMPLE_INTERVAL) {
+             return false;
+         }
+         this->last_sample_ = now;
+         return true;
+ #endif
+     }
+ 
+     void report(uint32_t now, const char *tag) {
+         if (now - this->last_report_ < TRACE_REPORT_INTERVAL) {
+             return;
+         }
+         this->last_report_ = now;
+         ESP_LOGD(tag, "Trace: %u bytes, %u simple, %u engineering, %u config, %u invalid frames",
+                  static_cast<uint32_t>(this->bytes_),
+                  static_cast<uint32_t>(this->frames_[static_cast<uint8_t>(FrameType::SIMPLE)]),
+                  static_cast<uint32_t>(this->frames_[static_cast<uint8_t>(FrameType::ENGINEERING)]),
+                  static_cast<uint32_t>(this->frames_[static_cast<uint8_t>(FrameType::CONFIG)]),
+                  static_cast<uint32_t>(this->frames_[static_cast<uint8_t>(FrameType::INVALID)]));
+     }
+ 
+  protected:
+     // Counted where bytes are read, which is the receive task with rx_task
+     TaskCounter bytes_{0};
+     TaskCounter frames_[static_cast<uint8_t>(FrameType::INVALID) + 1]{};
+     uint32_t last_sample_{0};
+     uint32_t last_report_{0};
+ };
+ #else
+ class Tracer {
+  public:
+     void count_bytes(size_t /*count*/) {}
+     void count_frame(FrameType /*frame*/) {}
+     bool sample(uint32_t /*now*/) { return false; }
+     void report(uint32_t /*now*/, const char * /*tag*/) {}
+ };
+ #endif
+ 
+ }  // namespace hlk_ld2410s
+ }  // namespace esphome
\ No newline at end of file
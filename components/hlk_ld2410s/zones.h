@@ -0,0 +1,74 @@
+/**
+ * Gate-range occupancy zones for the HLK-LD2410S component.
+ *
+ * A zone covers a contiguous range of gates. It is occupied while any of its
+ * gates is, with trigger/hold hysteresis per gate against the radar's own
+ * threshold tables, so a zone agrees with the radar's presence decision for
+ * the same gates. The zone's scalar thresholds stand in for every gate while
+ * the tables are unknown. The strongest gate energy in the range feeds a
+ * GateWindow for the zone energy sensor. A zone is a few bytes of fixed
+ * state; nothing is allocated.
+ *
+ * Author: mouldybread
+ */
+
+ #pragma once
+ 
+ #include <cstdint>
+ 
+ #include "aggregation.h"
+ 
+ namespace esphome {
+ namespace hlk_ld2410s {
+ 
+ static const uint8_t MAX_ZONES = 8;
+ 
+ class Zone {
+  public:
+     void configure(uint8_t first_gate, uint8_t last_gate, uint8_t trigger, uint8_t hold) {
+         this->first_gate_ = first_gate;
+         this->last_gate_ = last_gate;
+         this->trigger_ = trigger;
+         this->hold_ = hold;
+     }
+ 
+     // Folds one frame's gate energies in; returns true when occupancy should be published.
+     // trigger and hold are the radar's per-gate tables, or nullptr while they are unknown.
+     bool update(const uint8_t *gate_energy, const uint8_t *trigger, const uint8_t *hold) {
+         uint8_t energy = 0;
+         bool occupied = false;
+         for (uint8_t i = this->first_gate_; i <= this->last_gate_; i++) {
+             if (gate_energy[i] > energy) {
+                 energy = gate_energy[i];
+             }
+             // Entering takes the trigger threshold, staying only the lower hold threshold
+             const uint8_t threshold = this->occupied_ ? (hold != nullptr ? hold[i] : this->hold_)
+                                                       : (trigger != nullptr ? trigger[i] : this->trigger_);
+             occupied |= gate_energy[i] >= threshold;
+         }
+         this->energy_ = energy;
+         this->window_.add(energy);
+ 
+         const bool publish = occupied != this->occupied_ || !this->reported_;
+         this->occupied_ = occupied;
+         this->reported_ = true;
+         return publish;
+     }
+ 
+     bool occupied() const { return this->occupied_; }
+     uint8_t energy() const { return this->energy_; }
+     GateWindow &window() { return this->window_; }
+ 
+  protected:
+     uint8_t first_gate_{0};
+     uint8_t last_gate_{0};
+     uint8_t trigger_{0};
+     uint8_t hold_{0};
+     uint8_t energy_{0};
+     bool occupied_{false};
+     bool reported_{false};
+     GateWindow window_;
+ };
+ 
+ }  // namespace hlk_ld2410s
+ }  // namespace esphome
\ No newline at end of file
@@ -0,0 +1,199 @@
+/**
+ * Configuration session test for the HLK-LD2410S component.
+ *
+ * Builds hlk_ld2410s.cpp unmodified against the host stand-ins in
+ * tools/host, with the mock radar there acknowledging every command. The
+ * mock does not report its parameters, as with firmware that lacks the read
+ * commands. The first boot writes the configuration and stores it. The
+ * second boot finds it stored and skips the writes, while a control is
+ * changed in the middle of that boot. The test checks that the change still
+ * reaches the radar in the runtime session that follows. Control values are
+ * also checked: report frequencies are rounded to tenths of a Hz and gates
+ * have to be whole numbers.
+ *
+ * Built with -DHLK_LD2410S_ADAPTIVE_REPORT it also empties the room and
+ * fails the write that slows distance reports down. The write has to be
+ * repeated until it succeeds, and status reports have to stay fast.
+ *
+ * Build and run on a host:
+ *   g++ -O1 -std=gnu++17 -Itools/host -Icomponents/hlk_ld2410s tools/config_session_test.cpp \
+ *       tools/host/host.cpp components/hlk_ld2410s/hlk_ld2410s.cpp components/hlk_ld2410s/frame_parser.cpp \
+ *       -o config_session_test -lpthread
+ *   ./config_session_test
+ *
+ * Author: mouldybread
+ */
+
+ #include <cstdio>
+ #include <vector>
+ 
+ #include "host.h"
+ #include "hlk_ld2410s.h"
+ 
+ using namespace esphome;
+ using namespace esphome::hlk_ld2410s;
+ 
+ static const int MAX_LOOPS = 10000;
+ static const size_t COMMAND = ConfigFrame::Command::OFFSET;
+ static const uint8_t CHANGED_UNMANNED_DELAY = 30;
+ 
+ class TestComponent : public HLKLD2410SComponent {
+  public:
+     using HLKLD2410SComponent::HLKLD2410SComponent;
+     bool commands_pending() const { return !this->command_queue_.empty(); }
+ };
+ 
+ // Every command the component sent, with its payload
+ struct CommandLog {
+     std::vector<std::vector<uint8_t>> frames;
+ 
+     void record(const uint8_t *frame, size_t length) { this->frames.emplace_back(frame, frame + length); }
+     size_t count(CommandWord word) const {
+         size_t count = 0;
+         for (const auto &frame : this->frames) {
+             count += frame[COMMAND] == static_cast<uint8_t>(word);
+         }
+         return count;
+     }
+     // Whether any WRITE_PARAMETERS frame carried id with value
+     bool wrote(ParameterId id, uint32_t value) const {
+         for (const auto &frame : this->frames) {
+             if (frame[COMMAND] != static_cast<uint8_t>(CommandWord::WRITE_PARAMETERS)) {
+                 continue;
+             }
+             // The frame ends with a checksum byte
+             for (size_t entry = ConfigFrame::COMMAND_PAYLOAD; entry + ParameterEntryLayout::SIZE < frame.size();
+                  entry += ParameterEntryLayout::SIZE) {
+                 if (ParameterEntryLayout::Id::read(frame.data() + entry) == static_cast<uint16_t>(id) &&
+                     ParameterEntryLayout::Value::read(frame.data() + entry) == value) {
+                     return true;
+                 }
+             }
+         }
+         return false;
+     }
+ };
+ 
+ #ifdef HLK_LD2410S_ADAPTIVE_REPORT
+ // Acknowledges every command, but parameter writes fail while failing is set
+ static void acknowledge(uart::UARTComponent &uart, CommandLog &log, const bool &failing) {
+     uart.set_tx_callback([&uart, &log, &failing](const uint8_t *frame, size_t length) {
+         log.record(frame, length);
+         const uint8_t command = frame[COMMAND];
+         const bool fail = failing && command == static_cast<uint8_t>(CommandWord::WRITE_PARAMETERS);
+         const std::vector<uint8_t> ack = host::ack_frame(
+             command, static_cast<uint8_t>(fail ? ResponseStatus::FAILURE : ResponseStatus::SUCCESS));
+         uart.inject(ack.data(), ack.size());
+     });
+ }
+ 
+ // Runs for ms with an empty room reported every 100 ms
+ static void run_empty(TestComponent &radar, uart::UARTComponent &uart, uint32_t ms) {
+     static const uint8_t EMPTY[] = {0x6E, 0x00, 0x00, 0x00, 0x62};
+     for (uint32_t t = 0; t < ms; t += 10) {
+         if (t % 100 == 0) {
+             uart.inject(EMPTY, sizeof(EMPTY));
+         }
+         radar.loop();
+         host::advance(10);
+     }
+ }
+ #endif
+ 
+ // Loops until the queue drains, moving the clock so debounced sessions start
+ static void settle(TestComponent &radar) {
+     for (int i = 0; i < MAX_LOOPS; i++) {
+         radar.loop();
+         host::advance(10);
+     }
+ }
+ 
+ static bool check(bool condition, const char *what) {
+     if (!condition) {
+         fprintf(stderr, "FAIL: %s\n", what);
+     }
+     return condition;
+ }
+ 
+ int main() {
+     host::set_manual_clock(true);
+     host::clear_preferences();
+     bool ok = true;
+ 
+     {
+         uart::UARTComponent uart;
+         CommandLog log;
+         host::acknowledge_commands(uart, [&log](const uint8_t *frame, size_t length) { log.record(frame, length); });
+         TestComponent radar(&uart);
+         radar.set_preference_key("session");
+         radar.setup();
+         settle(radar);
+         ok &= check(log.count(CommandWord::SWITCH_OUTPUT_MODE) == 1, "first boot writes the configuration");
+         ok &= check(host::preference_saves() == 1, "first boot stores the configuration");
+     }
+ 
+     {
+         uart::UARTComponent uart;
+         CommandLog log;
+         bool reading = false;
+         host::acknowledge_commands(uart, [&log, &reading](const uint8_t *frame, size_t length) {
+             log.record(frame, length);
+             reading |= frame[COMMAND] == static_cast<uint8_t>(CommandWord::READ_PARAMETERS);
+         });
+         TestComponent radar(&uart);
+         radar.set_preference_key("session");
+         radar.setup();
+         // Change a control once boot is reading the radar back, before it decides to skip
+         bool changed = false;
+         for (int i = 0; i < MAX_LOOPS && radar.commands_pending(); i++) {
+             radar.loop();
+             if (reading && !changed) {
+                 changed = radar.update_control(Control::UNMANNED_DELAY, CHANGED_UNMANNED_DELAY);
+             }
+         }
+         ok &= check(changed, "control changed during boot");
+         ok &= check(log.count(CommandWord::SWITCH_OUTPUT_MODE) == 0, "second boot skips the stored configuration");
+         settle(radar);
+         ok &= check(log.wrote(ParameterId::UNMANNED_DELAY, CHANGED_UNMANNED_DELAY),
+                     "the change made during boot is written");
+ 
+         // A lambda's arithmetic can land just below a tenth of a Hz
+         ok &= check(radar.update_control(Control::STATUS_REPORT_FREQUENCY, 2.99f), "frequency accepted");
+         ok &= check(!radar.update_control(Control::NEAREST_GATE, 2.5f), "fractional gate rejected");
+         settle(radar);
+         ok &= check(log.wrote(ParameterId::STATUS_REPORT_FREQUENCY, 30), "frequency written rounded");
+     }
+ 
+#ifdef HLK_LD2410S_ADAPTIVE_REPORT
+     {
+         uart::UARTComponent uart;
+         CommandLog log;
+         bool failing = false;
+         acknowledge(uart, log, failing);
+         TestComponent radar(&uart);
+         binary_sensor::BinarySensor presence;
+         radar.set_presence_sensor(&presence);
+         radar.set_output_mode(false);
+         radar.set_adaptive_report(0.5f, 8.0f, 10000);
+         radar.set_preference_key("adaptive");
+         radar.setup();
+         run_empty(radar, uart, 1000);
+         ok &= check(log.wrote(ParameterId::STATUS_REPORT_FREQUENCY, 80) &&
+                     log.wrote(ParameterId::DISTANCE_REPORT_FREQUENCY, 80), "boot at the active frequency");
+ 
+         failing = true;
+         run_empty(radar, uart, 10000);
+         ok &= check(log.wrote(ParameterId::DISTANCE_REPORT_FREQUENCY, 5), "empty room switches distance reports");
+         const size_t writes = log.count(CommandWord::WRITE_PARAMETERS);
+         failing = false;
+         run_empty(radar, uart, ADAPTIVE_REPORT_RETRY_INTERVAL + 1000);
+         ok &= check(log.count(CommandWord::WRITE_PARAMETERS) == writes + 1, "failed switch is written once more");
+         run_empty(radar, uart, 2 * ADAPTIVE_REPORT_RETRY_INTERVAL);
+         ok &= check(log.count(CommandWord::WRITE_PARAMETERS) == writes + 1, "no writes once the radar took it");
+         ok &= check(!log.wrote(ParameterId::STATUS_REPORT_FREQUENCY, 5), "status reports stay at the active frequency");
+     }
+ #endif
+ 
+     printf(ok ? "PASS\n" : "FAILED\n");
+     return ok ? 0 : 1;
+ }
\ No newline at end of file
@@ -0,0 +1,125 @@
+#!/usr/bin/env python3
+"""Decode an HLK-LD2410S flight recorder dump.
+
+Reads ESPHome log output containing a dump produced by the
+hlk_ld2410s.dump_flight_recorder action, lists the records and can
+rebuild the radar-to-ESP byte stream for offline replay through the
+frame parser.
+
+Usage:
+    flight_recorder.py LOG [--replay OUT.bin]
+
+Created by github.com/mouldybread
+"""
+
+import argparse
+import base64
+import struct
+import sys
+
+DUMP_BEGIN = 'Recorder dump:'
+DUMP_DATA = 'Recorder data: '
+DUMP_END = 'Recorder dump end'
+MAGIC = b'HLKR'
+FORMAT_VERSION = 1
+
+KIND_SIMPLE = 1
+KIND_ENGINEERING = 2
+KIND_ACK = 3
+KIND_REJECTED = 4
+KIND_COMMAND = 5
+KIND_NAMES = {
+    KIND_SIMPLE: 'simple',
+    KIND_ENGINEERING: 'engineering',
+    KIND_ACK: 'ack',
+    KIND_REJECTED: 'rejected',
+    KIND_COMMAND: 'command',
+}
+
+DATA_FRAME_HEADER = bytes([0xF4, 0xF3, 0xF2, 0xF1])
+DATA_FRAME_FOOTER = bytes([0xF8, 0xF7, 0xF6, 0xF5])
+ENGINEERING_PAYLOAD_LENGTH = 65
+
+
+def extract_dump(lines):
+    """Returns the raw bytes of the last complete dump in the log."""
+    dump = None
+    chunks = None
+    for line in lines:
+        if DUMP_BEGIN in line:
+            chunks = []
+        elif chunks is not None and DUMP_DATA in line:
+            chunks.append(line.split(DUMP_DATA, 1)[1].strip())
+        elif chunks is not None and DUMP_END in line:
+            dump = b''.join(base64.b64decode(chunk) for chunk in chunks)
+            chunks = None
+    if dump is None:
+        raise ValueError('no complete flight recorder dump found')
+    return dump
+
+
+def parse_records(dump):
+    if dump[:4] != MAGIC:
+        raise ValueError('not a flight recorder dump')
+    version, count = struct.unpack_from('<BH', dump, 4)
+    if version != FORMAT_VERSION:
+        raise ValueError(f'unsupported dump format version {version}')
+    records = []
+    offset = 7
+    while offset + 6 <= len(dump):
+        kind, length, timestamp = struct.unpack_from('<BBI', dump, offset)
+        offset += 6
+        records.append((timestamp, kind, dump[offset:offset + length]))
+        offset += length
+    if len(records) != count:
+        print(f'warning: header says {count} records, found {len(records)}', file=sys.stderr)
+    return records
+
+
+def describe(kind, payload):
+    if kind == KIND_SIMPLE and len(payload) == 2:
+        return f'state={payload[0]} distance={payload[1]}cm'
+    if kind == KIND_ENGINEERING and len(payload) == 20:
+        frame_type, state, distance = struct.unpack_from('<BBH', payload)
+        gates = ' '.join(str(energy) for energy in payload[4:])
+        return f'type={frame_type} state={state} distance={distance}cm gates=[{gates}]'
+    return payload.hex(' ')
+
+
+def rebuild_frame(kind, payload):
+    """Returns the bytes the radar sent for a record, or None for our own commands."""
+    if kind == KIND_SIMPLE:
+        return bytes([0x6E, payload[0], payload[1], 0x00, 0x62])
+    if kind == KIND_ENGINEERING:
+        body = bytes(payload[:4]) + bytes(2) + bytes(payload[4:])
+        body += bytes(ENGINEERING_PAYLOAD_LENGTH - len(body))
+        return DATA_FRAME_HEADER + struct.pack('<H', ENGINEERING_PAYLOAD_LENGTH) + body + DATA_FRAME_FOOTER
+    if kind in (KIND_ACK, KIND_REJECTED):
+        return bytes(payload)
+    return None
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('log', help='ESPHome log containing a dump, - for stdin')
+    parser.add_argument('--replay', help='write the received byte stream to this file')
+    args = parser.parse_args()
+
+    with (sys.stdin if args.log == '-' else open(args.log, encoding='utf-8', errors='replace')) as log:
+        records = parse_records(extract_dump(log))
+
+    start = records[0][0] if records else 0
+    for timestamp, kind, payload in records:
+        name = KIND_NAMES.get(kind, f'kind {kind}')
+        print(f'{timestamp - start:>8} ms  {name:<12} {describe(kind, payload)}')
+
+    if args.replay:
+        with open(args.replay, 'wb') as out:
+            for _, kind, payload in records:
+                frame = rebuild_frame(kind, payload)
+                if frame is not None:
+                    out.write(frame)
+
+
+if __name__ == '__main__':
+    main()
\ No newline at end of file
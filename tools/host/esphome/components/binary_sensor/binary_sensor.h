@@ -0,0 +1,28 @@
+/**
+ * Host stand-in for esphome::binary_sensor::BinarySensor; keeps the last
+ * state and counts publishes.
+ *
+ * Author: mouldybread
+ */
+
+ #pragma once
+ 
+ #include <cstdint>
+ 
+ namespace esphome {
+ namespace binary_sensor {
+ 
+ class BinarySensor {
+  public:
+     void publish_state(bool state) {
+         this->state = state;
+         this->publishes++;
+     }
+     bool has_state() const { return this->publishes > 0; }
+ 
+     bool state{false};
+     uint32_t publishes{0};
+ };
+ 
+ }  // namespace binary_sensor
+ }  // namespace esphome
\ No newline at end of file
@@ -0,0 +1,22 @@
+/**
+ * Host stand-in for esphome::button::Button; press() runs the action.
+ *
+ * Author: mouldybread
+ */
+
+ #pragma once
+ 
+ namespace esphome {
+ namespace button {
+ 
+ class Button {
+  public:
+     virtual ~Button() = default;
+     void press() { this->press_action(); }
+ 
+  protected:
+     virtual void press_action() = 0;
+ };
+ 
+ }  // namespace button
+ }  // namespace esphome
\ No newline at end of file
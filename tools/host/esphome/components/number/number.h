@@ -0,0 +1,26 @@
+/**
+ * Host stand-in for esphome::number::Number; make_call() is reduced to
+ * set(), which hands the value to control() like a user change would.
+ *
+ * Author: mouldybread
+ */
+
+ #pragma once
+ 
+ namespace esphome {
+ namespace number {
+ 
+ class Number {
+  public:
+     virtual ~Number() = default;
+     void set(float value) { this->control(value); }
+     void publish_state(float state) { this->state = state; }
+ 
+     float state{0.0f};
+ 
+  protected:
+     virtual void control(float value) = 0;
+ };
+ 
+ }  // namespace number
+ }  // namespace esphome
\ No newline at end of file
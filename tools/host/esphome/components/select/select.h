@@ -0,0 +1,28 @@
+/**
+ * Host stand-in for esphome::select::Select; set() hands the option to
+ * control() like a user change would.
+ *
+ * Author: mouldybread
+ */
+
+ #pragma once
+ 
+ #include <string>
+ 
+ namespace esphome {
+ namespace select {
+ 
+ class Select {
+  public:
+     virtual ~Select() = default;
+     void set(const std::string &value) { this->control(value); }
+     void publish_state(const std::string &state) { this->state = state; }
+ 
+     std::string state;
+ 
+  protected:
+     virtual void control(const std::string &value) = 0;
+ };
+ 
+ }  // namespace select
+ }  // namespace esphome
\ No newline at end of file
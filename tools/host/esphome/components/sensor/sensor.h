@@ -0,0 +1,28 @@
+/**
+ * Host stand-in for esphome::sensor::Sensor; keeps the last state and counts
+ * publishes.
+ *
+ * Author: mouldybread
+ */
+
+ #pragma once
+ 
+ #include <cstdint>
+ 
+ namespace esphome {
+ namespace sensor {
+ 
+ class Sensor {
+  public:
+     void publish_state(float state) {
+         this->state = state;
+         this->publishes++;
+     }
+     bool has_state() const { return this->publishes > 0; }
+ 
+     float state{0.0f};
+     uint32_t publishes{0};
+ };
+ 
+ }  // namespace sensor
+ }  // namespace esphome
\ No newline at end of file
@@ -0,0 +1,27 @@
+/**
+ * Host stand-in for esphome::text_sensor::TextSensor.
+ *
+ * Author: mouldybread
+ */
+
+ #pragma once
+ 
+ #include <cstdint>
+ #include <string>
+ 
+ namespace esphome {
+ namespace text_sensor {
+ 
+ class TextSensor {
+  public:
+     void publish_state(const std::string &state) {
+         this->state = state;
+         this->publishes++;
+     }
+ 
+     std::string state;
+     uint32_t publishes{0};
+ };
+ 
+ }  // namespace text_sensor
+ }  // namespace esphome
\ No newline at end of file
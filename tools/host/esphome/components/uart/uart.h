@@ -0,0 +1,58 @@
+/**
+ * Host stand-in for the ESPHome UART bus. UARTComponent is a loopback
+ * buffer: inject() queues bytes as if the radar had sent them, and whatever
+ * the component writes goes to the tx callback. A mutex guards the buffer so
+ * a receive task thread can read while the harness injects.
+ *
+ * Author: mouldybread
+ */
+
+ #pragma once
+ 
+ #include <cstddef>
+ #include <cstdint>
+ #include <functional>
+ #include <mutex>
+ #include <vector>
+ 
+ namespace esphome {
+ namespace uart {
+ 
+ class UARTComponent {
+  public:
+     using TxCallback = std::function<void(const uint8_t *data, size_t length)>;
+ 
+     void inject(const uint8_t *data, size_t length);
+     void set_tx_callback(TxCallback callback) { this->tx_callback_ = std::move(callback); }
+     // Reserves buffer space up front so reads and injects inside a benchmark never allocate
+     void reserve(size_t length) { this->rx_.reserve(length); }
+ 
+     size_t available();
+     bool read_array(uint8_t *data, size_t length);
+     void write_array(const uint8_t *data, size_t length);
+ 
+  protected:
+     std::mutex mutex_;
+     std::vector<uint8_t> rx_;
+     size_t rx_position_{0};
+     TxCallback tx_callback_;
+ };
+ 
+ class UARTDevice {
+  public:
+     UARTDevice() = default;
+     explicit UARTDevice(UARTComponent *parent) : parent_(parent) {}
+     void set_uart_parent(UARTComponent *parent) { this->parent_ = parent; }
+ 
+     int available() { return static_cast<int>(this->parent_->available()); }
+     bool read_array(uint8_t *data, size_t length) { return this->parent_->read_array(data, length); }
+     bool read_byte(uint8_t *data) { return this->parent_->read_array(data, 1); }
+     void write_array(const uint8_t *data, size_t length) { this->parent_->write_array(data, length); }
+     void flush() {}
+ 
+  protected:
+     UARTComponent *parent_{nullptr};
+ };
+ 
+ }  // namespace uart
+ }  // namespace esphome
\ No newline at end of file
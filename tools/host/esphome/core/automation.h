@@ -0,0 +1,45 @@
+/**
+ * Host stand-in for esphome/core/automation.h, enough for the component's
+ * actions. Templatable values only hold constants.
+ *
+ * Author: mouldybread
+ */
+
+ #pragma once
+ 
+ namespace esphome {
+ 
+ template<typename T, typename... X> class TemplatableValue {
+  public:
+     TemplatableValue() = default;
+     TemplatableValue(T value) : has_value_(true), value_(value) {}
+     bool has_value() const { return this->has_value_; }
+     T value(X... x) const { return this->value_; }
+ 
+  protected:
+     bool has_value_{false};
+     T value_{};
+ };
+ 
+ #define TEMPLATABLE_VALUE(type, name) \
+  protected: \
+     TemplatableValue<type, Ts...> name##_{}; \
+ \
+  public: \
+     template<typename V> void set_##name(V name) { this->name##_ = name; }
+ 
+ template<typename... Ts> class Action {
+  public:
+     virtual ~Action() = default;
+     virtual void play(Ts... x) = 0;
+ };
+ 
+ template<typename T> class Parented {
+  public:
+     void set_parent(T *parent) { this->parent_ = parent; }
+ 
+  protected:
+     T *parent_{nullptr};
+ };
+ 
+ }  // namespace esphome
\ No newline at end of file
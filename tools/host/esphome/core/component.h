@@ -0,0 +1,34 @@
+/**
+ * Host stand-in for esphome/core/component.h. Components are driven by
+ * calling setup() and loop() directly; there is no scheduler.
+ *
+ * Author: mouldybread
+ */
+
+ #pragma once
+ 
+ #include "esphome/core/hal.h"
+ 
+ namespace esphome {
+ 
+ namespace setup_priority {
+ const float DATA = 600.0f;
+ const float LATE = -100.0f;
+ }  // namespace setup_priority
+ 
+ class Component {
+  public:
+     virtual ~Component() = default;
+     virtual void setup() {}
+     virtual void loop() {}
+     virtual void dump_config() {}
+     virtual float get_setup_priority() const { return 0.0f; }
+ 
+     void mark_failed() { this->failed_ = true; }
+     bool is_failed() const { return this->failed_; }
+ 
+  protected:
+     bool failed_{false};
+ };
+ 
+ }  // namespace esphome
\ No newline at end of file
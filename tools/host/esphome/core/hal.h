@@ -0,0 +1,19 @@
+/**
+ * Host stand-in for esphome/core/hal.h; the clock is host::Clock in host.cpp.
+ *
+ * Author: mouldybread
+ */
+
+ #pragma once
+ 
+ #include <cstdint>
+ 
+ namespace esphome {
+ 
+ uint32_t millis();
+ uint32_t micros();
+ void delay(uint32_t ms);
+ void delayMicroseconds(uint32_t us);
+ void yield();
+ 
+ }  // namespace esphome
\ No newline at end of file
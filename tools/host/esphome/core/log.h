@@ -0,0 +1,66 @@
+/**
+ * Host stand-in for esphome/core/log.h.
+ *
+ * Messages up to ESPHOME_LOG_LEVEL are formatted, like on the device with the
+ * default DEBUG logger, so their cost shows up in host benchmarks. Only those
+ * up to host::log_level are printed.
+ *
+ * Author: mouldybread
+ */
+
+ #pragma once
+ 
+ #include <atomic>
+ #include <cstdint>
+ 
+ #define ESPHOME_LOG_LEVEL_NONE 0
+ #define ESPHOME_LOG_LEVEL_ERROR 1
+ #define ESPHOME_LOG_LEVEL_WARN 2
+ #define ESPHOME_LOG_LEVEL_INFO 3
+ #define ESPHOME_LOG_LEVEL_CONFIG 4
+ #define ESPHOME_LOG_LEVEL_DEBUG 5
+ #define ESPHOME_LOG_LEVEL_VERBOSE 6
+ #define ESPHOME_LOG_LEVEL_VERY_VERBOSE 7
+ 
+ #ifndef ESPHOME_LOG_LEVEL
+ #define ESPHOME_LOG_LEVEL ESPHOME_LOG_LEVEL_DEBUG
+ #endif
+ 
+ namespace esphome {
+ namespace host {
+ 
+ extern int log_level;           // printed up to this level
+ extern std::atomic<uint32_t> log_messages;  // formatted since start, printed or not; RX_TASK logs too
+ void log(int level, const char *tag, const char *format, ...) __attribute__((format(printf, 3, 4)));
+ 
+ }  // namespace host
+ }  // namespace esphome
+ 
+ #define ESP_LOGE(tag, ...) ::esphome::host::log(ESPHOME_LOG_LEVEL_ERROR, tag, __VA_ARGS__)
+ #define ESP_LOGW(tag, ...) ::esphome::host::log(ESPHOME_LOG_LEVEL_WARN, tag, __VA_ARGS__)
+ #define ESP_LOGI(tag, ...) ::esphome::host::log(ESPHOME_LOG_LEVEL_INFO, tag, __VA_ARGS__)
+ #define ESP_LOGCONFIG(tag, ...) ::esphome::host::log(ESPHOME_LOG_LEVEL_CONFIG, tag, __VA_ARGS__)
+ #define ESP_LOGD(tag, ...) ::esphome::host::log(ESPHOME_LOG_LEVEL_DEBUG, tag, __VA_ARGS__)
+ #if ESPHOME_LOG_LEVEL >= ESPHOME_LOG_LEVEL_VERBOSE
+ #define ESP_LOGV(tag, ...) ::esphome::host::log(ESPHOME_LOG_LEVEL_VERBOSE, tag, __VA_ARGS__)
+ #else
+ #define ESP_LOGV(tag, ...) ((void) 0)
+ #endif
+ #if ESPHOME_LOG_LEVEL >= ESPHOME_LOG_LEVEL_VERY_VERBOSE
+ #define ESP_LOGVV(tag, ...) ::esphome::host::log(ESPHOME_LOG_LEVEL_VERY_VERBOSE, tag, __VA_ARGS__)
+ #else
+ #define ESP_LOGVV(tag, ...) ((void) 0)
+ #endif
+ 
+ #define LOG_ENTITY_(prefix, type, obj) \
+     do { \
+         if ((obj) != nullptr) { \
+             ESP_LOGCONFIG(TAG, "%s%s", prefix, type); \
+         } \
+     } while (0)
+ #define LOG_SENSOR(prefix, type, obj) LOG_ENTITY_(prefix, type, obj)
+ #define LOG_BINARY_SENSOR(prefix, type, obj) LOG_ENTITY_(prefix, type, obj)
+ #define LOG_TEXT_SENSOR(prefix, type, obj) LOG_ENTITY_(prefix, type, obj)
+ #define LOG_BUTTON(prefix, type, obj) LOG_ENTITY_(prefix, type, obj)
+ #define LOG_NUMBER(prefix, type, obj) LOG_ENTITY_(prefix, type, obj)
+ #define LOG_SELECT(prefix, type, obj) LOG_ENTITY_(prefix, type, obj)
\ No newline at end of file
@@ -0,0 +1,44 @@
+/**
+ * Host stand-in for esphome/core/preferences.h. Every key lives in one
+ * in-memory store that survives component instances, so a second instance
+ * with the same key behaves like a reboot.
+ *
+ * Author: mouldybread
+ */
+
+ #pragma once
+ 
+ #include <cstddef>
+ #include <cstdint>
+ 
+ namespace esphome {
+ namespace host {
+ 
+ bool preference_save(uint32_t key, const void *data, size_t length, bool in_flash);
+ bool preference_load(uint32_t key, void *data, size_t length);
+ 
+ }  // namespace host
+ 
+ class ESPPreferenceObject {
+  public:
+     ESPPreferenceObject() = default;
+     ESPPreferenceObject(uint32_t key, bool in_flash) : key_(key), in_flash_(in_flash) {}
+ 
+     template<typename T> bool save(const T *src) { return host::preference_save(this->key_, src, sizeof(T), this->in_flash_); }
+     template<typename T> bool load(T *dest) { return host::preference_load(this->key_, dest, sizeof(T)); }
+ 
+  protected:
+     uint32_t key_{0};
+     bool in_flash_{false};
+ };
+ 
+ class ESPPreferences {
+  public:
+     template<typename T> ESPPreferenceObject make_preference(uint32_t type, bool in_flash = false) {
+         return ESPPreferenceObject(type, in_flash);
+     }
+ };
+ 
+ extern ESPPreferences *global_preferences;
+ 
+ }  // namespace esphome
\ No newline at end of file
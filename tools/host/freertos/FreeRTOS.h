@@ -0,0 +1,17 @@
+/**
+ * Host stand-in for the FreeRTOS types the receive task uses.
+ *
+ * Author: mouldybread
+ */
+
+ #pragma once
+ 
+ #include <cstdint>
+ 
+ typedef void *TaskHandle_t;
+ typedef int BaseType_t;
+ typedef uint32_t TickType_t;
+ 
+ #define pdPASS 1
+ #define pdFAIL 0
+ #define pdMS_TO_TICKS(ms) (ms)
\ No newline at end of file
@@ -0,0 +1,28 @@
+/**
+ * Host stand-in for FreeRTOS tasks: a task is a detached std::thread and a
+ * tick is a millisecond. Define HOST_TASK_CREATE_FAILS to exercise the
+ * fallback path of a task that could not be created.
+ *
+ * Author: mouldybread
+ */
+
+ #pragma once
+ 
+ #include <chrono>
+ #include <thread>
+ 
+ #include "FreeRTOS.h"
+ 
+ inline BaseType_t xTaskCreate(void (*task)(void *), const char * /*name*/, uint32_t /*stack_size*/, void *arg,
+                               uint32_t /*priority*/, TaskHandle_t *handle) {
+ #ifdef HOST_TASK_CREATE_FAILS
+     return pdFAIL;
+ #else
+     std::thread *thread = new std::thread(task, arg);
+     thread->detach();
+     *handle = thread;
+     return pdPASS;
+ #endif
+ }
+ 
+ inline void vTaskDelay(TickType_t ticks) { std::this_thread::sleep_for(std::chrono::milliseconds(ticks)); }
\ No newline at end of file
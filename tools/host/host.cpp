@@ -0,0 +1,195 @@
+/**
+ * Host implementations behind tools/host: clock, log sink, UART loopback
+ * and preference store.
+ *
+ * Author: mouldybread
+ */
+
+ #include "host.h"
+ 
+ #include <algorithm>
+ #include <chrono>
+ #include <cstdarg>
+ #include <cstdio>
+ #include <cstring>
+ #include <map>
+ #include <thread>
+ 
+ #include "esphome/components/uart/uart.h"
+ 
+ namespace esphome {
+ 
+ namespace {
+ 
+ using SteadyClock = std::chrono::steady_clock;
+ 
+ const SteadyClock::time_point START = SteadyClock::now();
+ bool manual_clock = false;
+ uint64_t manual_micros = 0;
+ 
+ uint64_t now_micros() {
+     if (manual_clock) {
+         return manual_micros;
+     }
+     return std::chrono::duration_cast<std::chrono::microseconds>(SteadyClock::now() - START).count();
+ }
+ 
+ struct StoredPreference {
+     std::vector<uint8_t> data;
+     bool in_flash{false};
+ };
+ 
+ std::map<uint32_t, StoredPreference> preferences;
+ uint32_t saves = 0;
+ 
+ }  // namespace
+ 
+ uint32_t millis() { return static_cast<uint32_t>(now_micros() / 1000); }
+ uint32_t micros() { return static_cast<uint32_t>(now_micros()); }
+ 
+ void delay(uint32_t ms) {
+     if (manual_clock) {
+         manual_micros += static_cast<uint64_t>(ms) * 1000;
+     } else {
+         std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+     }
+ }
+ 
+ void delayMicroseconds(uint32_t us) {
+     if (manual_clock) {
+         manual_micros += us;
+     } else {
+         std::this_thread::sleep_for(std::chrono::microseconds(us));
+     }
+ }
+ 
+ void yield() {}
+ 
+ static ESPPreferences preferences_instance;
+ ESPPreferences *global_preferences = &preferences_instance;
+ 
+ namespace host {
+ 
+ int log_level = ESPHOME_LOG_LEVEL_WARN;
+ std::atomic<uint32_t> log_messages{0};
+ 
+ void log(int level, const char *tag, const char *format, ...) {
+     // The logger formats into a fixed buffer whether or not anyone listens
+     static const char LEVELS[] = "NEWICDVV";
+     char message[512];
+     va_list args;
+     va_start(args, format);
+     vsnprintf(message, sizeof(message), format, args);
+     va_end(args);
+     log_messages++;
+     if (level <= log_level) {
+         printf("[%c][%s] %s\n", LEVELS[level], tag, message);
+     }
+ }
+ 
+ void set_manual_clock(bool manual) {
+     manual_micros = now_micros();
+     manual_clock = manual;
+ }
+ 
+ void advance(uint32_t ms) { manual_micros += static_cast<uint64_t>(ms) * 1000; }
+ 
+ bool preference_save(uint32_t key, const void *data, size_t length, bool in_flash) {
+     StoredPreference &preference = preferences[key];
+     const uint8_t *bytes = static_cast<const uint8_t *>(data);
+     preference.data.assign(bytes, bytes + length);
+     preference.in_flash = in_flash;
+     saves++;
+     return true;
+ }
+ 
+ bool preference_load(uint32_t key, void *data, size_t length) {
+     auto it = preferences.find(key);
+     if (it == preferences.end() || it->second.data.size() != length) {
+         return false;
+     }
+     memcpy(data, it->second.data.data(), length);
+     return true;
+ }
+ 
+ void clear_preferences() {
+     preferences.clear();
+     saves = 0;
+ }
+ 
+ uint32_t preference_saves() { return saves; }
+ 
+ bool preference_in_flash(uint32_t key) {
+     auto it = preferences.find(key);
+     return it != preferences.end() && it->second.in_flash;
+ }
+ 
+ std::vector<uint8_t> ack_frame(uint8_t command, uint8_t status, const uint8_t *data, size_t length) {
+     const size_t body = 2 + length;
+     std::vector<uint8_t> frame = {0xFD, 0xFC, 0xFB, 0xFA, static_cast<uint8_t>(body), static_cast<uint8_t>(body >> 8),
+                                   status, command};
+     frame.insert(frame.end(), data, data + length);
+     uint8_t checksum = 0;
+     for (uint8_t byte : frame) {
+         checksum += byte;
+     }
+     frame.push_back(checksum);
+     return frame;
+ }
+ 
+ void acknowledge_commands(uart::UARTComponent &uart, CommandObserver observer) {
+     uart.set_tx_callback([&uart, observer](const uint8_t *data, size_t length) {
+         // Command frames carry the command word right after header and length
+         static const size_t COMMAND = 6;
+         static const uint8_t READ_FIRMWARE_VERSION = 0x06;
+         static const uint8_t FIRMWARE[] = {0x00, 0x00, 0x04, 0x01, 0x14, 0x15, 0x06, 0x23};
+         if (length <= COMMAND) {
+             return;
+         }
+         if (observer) {
+             observer(data, length);
+         }
+         const uint8_t command = data[COMMAND];
+         const bool version = command == READ_FIRMWARE_VERSION;
+         const std::vector<uint8_t> ack = ack_frame(command, 0x01, version ? FIRMWARE : nullptr, version ? sizeof(FIRMWARE) : 0);
+         uart.inject(ack.data(), ack.size());
+     });
+ }
+ 
+ }  // namespace host
+ 
+ namespace uart {
+ 
+ void UARTComponent::inject(const uint8_t *data, size_t length) {
+     std::lock_guard<std::mutex> lock(this->mutex_);
+     // Drop what was read so the buffer does not grow with the stream
+     if (this->rx_position_ == this->rx_.size()) {
+         this->rx_.clear();
+         this->rx_position_ = 0;
+     }
+     this->rx_.insert(this->rx_.end(), data, data + length);
+ }
+ 
+ size_t UARTComponent::available() {
+     std::lock_guard<std::mutex> lock(this->mutex_);
+     return this->rx_.size() - this->rx_position_;
+ }
+ 
+ bool UARTComponent::read_array(uint8_t *data, size_t length) {
+     std::lock_guard<std::mutex> lock(this->mutex_);
+     if (this->rx_.size() - this->rx_position_ < length) {
+         return false;
+     }
+     std::copy(this->rx_.begin() + this->rx_position_, this->rx_.begin() + this->rx_position_ + length, data);
+     this->rx_position_ += length;
+     return true;
+ }
+ 
+ void UARTComponent::write_array(const uint8_t *data, size_t length) {
+     if (this->tx_callback_) {
+         this->tx_callback_(data, length);
+     }
+ }
+ 
+ }  // namespace uart
+ }  // namespace esphome
\ No newline at end of file
@@ -0,0 +1,51 @@
+/**
+ * Controls for the host build of the HLK-LD2410S component.
+ *
+ * tools/host holds stand-ins for the ESPHome and FreeRTOS headers the
+ * component includes, so hlk_ld2410s.cpp compiles and runs unmodified on
+ * Linux. Put this directory ahead of the component on the include path and
+ * link host.cpp:
+ *   g++ -std=gnu++17 -Itools/host -Icomponents/hlk_ld2410s <tool>.cpp tools/host/host.cpp \
+ *       components/hlk_ld2410s/hlk_ld2410s.cpp components/hlk_ld2410s/frame_parser.cpp -lpthread
+ * Feature defines (-DHLK_LD2410S_ENGINEERING etc.) are passed the way
+ * __init__.py would emit them.
+ *
+ * Author: mouldybread
+ */
+
+ #pragma once
+ 
+ #include <cstddef>
+ #include <cstdint>
+ #include <functional>
+ #include <vector>
+ 
+ #include "esphome/core/hal.h"
+ #include "esphome/core/log.h"
+ #include "esphome/core/preferences.h"
+ #include "esphome/components/uart/uart.h"
+ 
+ namespace esphome {
+ namespace host {
+ 
+ // millis()/micros() follow the steady clock from program start. A manual
+ // clock only moves with advance(), which makes timeouts deterministic.
+ void set_manual_clock(bool manual);
+ void advance(uint32_t ms);
+ 
+ // Preference store shared by every instance, see preferences.h
+ void clear_preferences();
+ uint32_t preference_saves();
+ bool preference_in_flash(uint32_t key);
+ 
+ // A configuration ACK as the radar sends it: status, echoed command word, data
+ std::vector<uint8_t> ack_frame(uint8_t command, uint8_t status, const uint8_t *data = nullptr, size_t length = 0);
+ 
+ // Mock radar on the UART that acknowledges every command with success. The
+ // firmware version it reports is a v1 build. observer, if given, sees each
+ // command frame before it is acknowledged.
+ using CommandObserver = std::function<void(const uint8_t *frame, size_t length)>;
+ void acknowledge_commands(uart::UARTComponent &uart, CommandObserver observer = nullptr);
+ 
+ }  // namespace host
+ }  // namespace esphome
\ No newline at end of file
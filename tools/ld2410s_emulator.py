@@ -0,0 +1,414 @@
+#!/usr/bin/env python3
+"""Emulate one or more HLK-LD2410S radars for soak and latency testing.
+
+Each emulated radar answers the configuration protocol the component uses
+(enable/disable configuration, firmware version, parameter reads and
+writes, output mode, thresholds and auto threshold) and streams simple or
+engineering frames at the configured report frequency while someone walks
+in and out of the room. Faults can be injected into ACKs and data frames.
+
+Every radar gets its own pseudo terminal, or a real serial port with
+--port (needs pyserial) to drive an ESP through a USB-UART adapter wired to
+its radar pins. Stop with Ctrl-C or SIGTERM for a summary of commands, frames and faults.
+
+Usage:
+    ld2410s_emulator.py [--radars N | --port DEV ...] [--drop-ack P]
+                        [--corrupt-checksum P] [--partial-frame P]
+                        [--ack-delay MS] [--ack-jitter MS] [--garbage P]
+
+Created by github.com/mouldybread
+"""
+
+import argparse
+import collections
+import os
+import random
+import select
+import signal
+import struct
+import sys
+import time
+import tty
+
+DATA_FRAME_HEADER = bytes([0xF4, 0xF3, 0xF2, 0xF1])
+DATA_FRAME_FOOTER = bytes([0xF8, 0xF7, 0xF6, 0xF5])
+CONFIG_FRAME_HEADER = bytes([0xFD, 0xFC, 0xFB, 0xFA])
+SIMPLE_FRAME_HEAD = 0x6E
+SIMPLE_FRAME_TAIL = 0x62
+ENGINEERING_PAYLOAD_LENGTH = 65
+MAX_GATES = 16
+
+# Command words, as in CommandWord in frame_codec.h
+ENABLE_CONFIGURATION = 0x04
+DISABLE_CONFIGURATION = 0x05
+READ_FIRMWARE_VERSION = 0x06
+WRITE_PARAMETERS = 0x07
+READ_PARAMETERS = 0x08
+SWITCH_OUTPUT_MODE = 0x0A
+RESTART = 0x0B
+RESTORE_FACTORY_SETTINGS = 0x0C
+READ_TRIGGER_THRESHOLD = 0x0D
+WRITE_TRIGGER_THRESHOLD = 0x0E
+READ_HOLD_THRESHOLD = 0x0F
+WRITE_HOLD_THRESHOLD = 0x10
+AUTO_THRESHOLD = 0x11
+COMMAND_NAMES = {
+    ENABLE_CONFIGURATION: 'enable_configuration',
+    DISABLE_CONFIGURATION: 'disable_configuration',
+    READ_FIRMWARE_VERSION: 'read_firmware_version',
+    WRITE_PARAMETERS: 'write_parameters',
+    READ_PARAMETERS: 'read_parameters',
+    SWITCH_OUTPUT_MODE: 'switch_output_mode',
+    RESTART: 'restart',
+    RESTORE_FACTORY_SETTINGS: 'restore_factory_settings',
+    READ_TRIGGER_THRESHOLD: 'read_trigger_threshold',
+    WRITE_TRIGGER_THRESHOLD: 'write_trigger_threshold',
+    READ_HOLD_THRESHOLD: 'read_hold_threshold',
+    WRITE_HOLD_THRESHOLD: 'write_hold_threshold',
+    AUTO_THRESHOLD: 'auto_threshold',
+}
+
+STATUS_SUCCESS = 0x01
+STATUS_FAILURE = 0x02
+STATUS_COMMAND_ERROR = 0x03
+
+# Parameter ids and factory values, as in ParameterId in hlk_ld2410s.h
+STATUS_REPORT_FREQUENCY = 0x02
+FARTHEST_GATE = 0x05
+UNMANNED_DELAY = 0x06
+NEAREST_GATE = 0x0A
+RESPONSE_SPEED = 0x0B
+DISTANCE_REPORT_FREQUENCY = 0x0C
+FACTORY_PARAMETERS = {
+    STATUS_REPORT_FREQUENCY: 5,  # tenths of a Hz
+    FARTHEST_GATE: 12,
+    UNMANNED_DELAY: 40,
+    NEAREST_GATE: 0,
+    RESPONSE_SPEED: 5,
+    DISTANCE_REPORT_FREQUENCY: 5,
+}
+
+FIRMWARE_TYPE = 0x2410
+FIRMWARE_MAJOR = 1
+FIRMWARE_MINOR = 0x05
+FIRMWARE_BUILD = 0x24101700
+
+GATE_LENGTH_CM = 70
+NOISE_FLOOR = 8
+
+
+def checksum(data):
+    return sum(data) & 0xFF
+
+
+def config_frame(body):
+    frame = CONFIG_FRAME_HEADER + struct.pack('<H', len(body)) + body
+    return frame + bytes([checksum(frame)])
+
+
+class Faults:
+    """Fault injection settings shared by every radar."""
+
+    def __init__(self, args):
+        self.drop_ack = args.drop_ack
+        self.corrupt_checksum = args.corrupt_checksum
+        self.partial_frame = args.partial_frame
+        self.garbage = args.garbage
+        self.ack_delay = args.ack_delay / 1000.0
+        self.ack_jitter = args.ack_jitter / 1000.0
+
+
+class Room:
+    """A target that walks in, moves around and leaves again."""
+
+    def __init__(self, rng, occupied, empty):
+        self.rng = rng
+        self.occupied = occupied
+        self.empty = empty
+        self.present = False
+        self.distance = 150
+        self.next_change = time.monotonic() + rng.uniform(0, empty)
+
+    def update(self, now):
+        if now >= self.next_change:
+            self.present = not self.present
+            period = self.occupied if self.present else self.empty
+            self.next_change = now + self.rng.uniform(0.5 * period, 1.5 * period)
+        if self.present:
+            self.distance = min(max(self.distance + self.rng.randint(-15, 15), 30), 800)
+
+    def gate_energies(self):
+        energies = [NOISE_FLOOR + self.rng.randint(0, 6) for _ in range(MAX_GATES)]
+        if self.present:
+            gate = min(self.distance // GATE_LENGTH_CM, MAX_GATES - 1)
+            for offset, energy in ((-1, 35), (0, 70), (1, 35)):
+                if 0 <= gate + offset < MAX_GATES:
+                    energies[gate + offset] = min(energies[gate + offset] + energy + self.rng.randint(0, 15), 100)
+        return energies
+
+
+class Radar:
+    def __init__(self, name, fd, faults, rng, room):
+        self.name = name
+        self.fd = fd
+        self.faults = faults
+        self.rng = rng
+        self.room = room
+        self.rx = bytearray()
+        self.outbox = []  # (due time, bytes), kept in order
+        self.config_mode = False
+        self.engineering = False
+        self.parameters = dict(FACTORY_PARAMETERS)
+        self.trigger_thresholds = bytes([40] * MAX_GATES)
+        self.hold_thresholds = bytes([30] * MAX_GATES)
+        self.auto_threshold_until = None
+        self.pending_thresholds = None
+        self.next_frame = time.monotonic()
+        self.commands = collections.Counter()
+        self.stats = collections.Counter()
+        self.ack_delays = []
+        self.sessions = 0
+
+    # Incoming commands
+
+    def receive(self, data):
+        self.rx += data
+        while True:
+            start = self.rx.find(CONFIG_FRAME_HEADER)
+            if start < 0:
+                del self.rx[:-3]
+                return
+            del self.rx[:start]
+            if len(self.rx) < 6:
+                return
+            length = struct.unpack_from('<H', self.rx, 4)[0]
+            if len(self.rx) < 6 + length + 1:
+                return
+            frame = bytes(self.rx[:6 + length + 1])
+            del self.rx[:len(frame)]
+            if frame[-1] != checksum(frame[:-1]) or length == 0:
+                self.stats['bad_commands'] += 1
+                continue
+            self.handle(frame[6], frame[7:-1])
+
+    def handle(self, command, payload):
+        self.commands[COMMAND_NAMES.get(command, f'0x{command:02X}')] += 1
+        status = STATUS_SUCCESS
+        data = b''
+        if command == ENABLE_CONFIGURATION:
+            self.config_mode = True
+            self.sessions += 1
+            data = struct.pack('<HH', 1, 64)  # protocol version, buffer size
+        elif not self.config_mode:
+            status = STATUS_FAILURE
+        elif command == DISABLE_CONFIGURATION:
+            self.config_mode = False
+        elif command == READ_FIRMWARE_VERSION:
+            data = struct.pack('<HBBI', FIRMWARE_TYPE, FIRMWARE_MINOR, FIRMWARE_MAJOR, FIRMWARE_BUILD)
+        elif command == WRITE_PARAMETERS:
+            status = self.write_parameters(payload)
+        elif command == READ_PARAMETERS:
+            status, data = self.read_parameters(payload)
+        elif command == SWITCH_OUTPUT_MODE and len(payload) >= 1:
+            self.engineering = payload[0] == 0x01
+        elif command == WRITE_TRIGGER_THRESHOLD and len(payload) == MAX_GATES:
+            self.trigger_thresholds = payload
+        elif command == WRITE_HOLD_THRESHOLD and len(payload) == MAX_GATES:
+            self.hold_thresholds = payload
+        elif command == READ_TRIGGER_THRESHOLD:
+            data = self.trigger_thresholds
+        elif command == READ_HOLD_THRESHOLD:
+            data = self.hold_thresholds
+        elif command == AUTO_THRESHOLD and len(payload) >= 3:
+            self.auto_threshold(payload[0], payload[1], payload[2])
+        elif command in (RESTART, RESTORE_FACTORY_SETTINGS):
+            if command == RESTORE_FACTORY_SETTINGS:
+                self.parameters = dict(FACTORY_PARAMETERS)
+        else:
+            status = STATUS_COMMAND_ERROR
+        self.acknowledge(command, status, data)
+
+    def write_parameters(self, payload):
+        if len(payload) % 6 != 0:
+            return STATUS_FAILURE
+        for offset in range(0, len(payload), 6):
+            parameter, value = struct.unpack_from('<HI', payload, offset)
+            if parameter not in self.parameters:
+                return STATUS_FAILURE
+            self.parameters[parameter] = value
+        return STATUS_SUCCESS
+
+    def read_parameters(self, payload):
+        if len(payload) % 2 != 0:
+            return STATUS_FAILURE, b''
+        data = b''
+        for offset in range(0, len(payload), 2):
+            parameter = struct.unpack_from('<H', payload, offset)[0]
+            if parameter not in self.parameters:
+                return STATUS_FAILURE, b''
+            data += struct.pack('<I', self.parameters[parameter])
+        return STATUS_SUCCESS, data
+
+    def auto_threshold(self, trigger_factor, hold_factor, scan_time):
+        # The scan finishes in the background; thresholds follow the noise floor
+        self.auto_threshold_until = time.monotonic() + scan_time
+        self.pending_thresholds = (
+            bytes(min(NOISE_FLOOR * (2 + trigger_factor), 100) for _ in range(MAX_GATES)),
+            bytes(min(NOISE_FLOOR * (1 + hold_factor), 100) for _ in range(MAX_GATES)),
+        )
+
+    def acknowledge(self, command, status, data):
+        if self.rng.random() < self.faults.drop_ack:
+            self.stats['dropped_acks'] += 1
+            return
+        frame = bytearray(config_frame(bytes([status, command]) + data))
+        if self.rng.random() < self.faults.corrupt_checksum:
+            frame[-1] ^= 0xFF
+            self.stats['corrupted_acks'] += 1
+        delay = self.faults.ack_delay + self.rng.uniform(0, self.faults.ack_jitter)
+        self.ack_delays.append(delay)
+        self.send(bytes(frame), delay)
+
+    # Outgoing data
+
+    def send(self, data, delay=0.0):
+        if self.rng.random() < self.faults.partial_frame:
+            data = data[:self.rng.randint(1, len(data) - 1)]
+            self.stats['partial_frames'] += 1
+        due = time.monotonic() + delay
+        # Later bytes never overtake a delayed ACK, as on a real wire
+        if self.outbox:
+            due = max(due, self.outbox[-1][0])
+        self.outbox.append((due, data))
+
+    def data_frame(self):
+        state = 2 if self.room.present else 0
+        if not self.engineering:
+            return bytes([SIMPLE_FRAME_HEAD, state, min(self.room.distance, 255), 0x00, SIMPLE_FRAME_TAIL])
+        payload = struct.pack('<BBH', 1, state, self.room.distance) + bytes(2) + bytes(self.room.gate_energies())
+        payload += bytes(ENGINEERING_PAYLOAD_LENGTH - len(payload))
+        return DATA_FRAME_HEADER + struct.pack('<H', len(payload)) + payload + DATA_FRAME_FOOTER
+
+    def frame_interval(self):
+        frequency = max(self.parameters[STATUS_REPORT_FREQUENCY], self.parameters[DISTANCE_REPORT_FREQUENCY]) / 10.0
+        return 1.0 / max(frequency, 0.5)
+
+    def tick(self, now):
+        if self.auto_threshold_until is not None and now >= self.auto_threshold_until:
+            self.trigger_thresholds, self.hold_thresholds = self.pending_thresholds
+            self.auto_threshold_until = None
+        # The radar stops reporting while in configuration mode
+        if now >= self.next_frame:
+            self.next_frame = now + self.frame_interval()
+            self.room.update(now)
+            if not self.config_mode:
+                if self.rng.random() < self.faults.garbage:
+                    self.send(bytes(self.rng.randint(0, 255) for _ in range(self.rng.randint(1, 32))))
+                    self.stats['garbage_bursts'] += 1
+                self.send(self.data_frame())
+                self.stats['engineering_frames' if self.engineering else 'simple_frames'] += 1
+        while self.outbox and self.outbox[0][0] <= now:
+            data = self.outbox.pop(0)[1]
+            try:
+                os.write(self.fd, data)
+            except BlockingIOError:
+                # Nobody is reading; a real radar keeps talking into the void as well
+                self.stats['unread_bytes'] += len(data)
+
+    def next_event(self):
+        events = [self.next_frame]
+        if self.outbox:
+            events.append(self.outbox[0][0])
+        if self.auto_threshold_until is not None:
+            events.append(self.auto_threshold_until)
+        return min(events)
+
+    def summary(self):
+        lines = [f'{self.name}: {self.sessions} configuration sessions, '
+                 f'{"engineering" if self.engineering else "simple"} mode at {1 / self.frame_interval():.1f} Hz']
+        for name, count in sorted(self.commands.items()):
+            lines.append(f'  {name:<26} {count}')
+        for name, count in sorted(self.stats.items()):
+            lines.append(f'  {name:<26} {count}')
+        if self.ack_delays:
+            delays = sorted(self.ack_delays)
+            percentile = lambda fraction: delays[int(fraction * (len(delays) - 1))] * 1000
+            lines.append(f'  ack delay ms               p50 {percentile(0.5):.1f}  p99 {percentile(0.99):.1f}  '
+                         f'max {delays[-1] * 1000:.1f}')
+        return '\n'.join(lines)
+
+
+def open_pty():
+    controller, device = os.openpty()
+    tty.setraw(device)
+    tty.setraw(controller)
+    return controller, device
+
+
+def open_port(path, baud):
+    import serial  # only needed for real ports
+    port = serial.Serial(path, baud, timeout=0)
+    return port.fileno(), port
+
+
+def stop(signum, frame):
+    raise KeyboardInterrupt
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('--radars', type=int, default=1, help='number of emulated radars on ptys (default 1)')
+    parser.add_argument('--port', action='append', default=[], help='serial port to emulate on, may be repeated')
+    parser.add_argument('--baud', type=int, default=115200)
+    parser.add_argument('--drop-ack', type=float, default=0.0, help='probability of not answering a command')
+    parser.add_argument('--corrupt-checksum', type=float, default=0.0, help='probability of a bad ACK checksum')
+    parser.add_argument('--partial-frame', type=float, default=0.0, help='probability of truncating a frame or ACK')
+    parser.add_argument('--garbage', type=float, default=0.0, help='probability of noise before a data frame')
+    parser.add_argument('--ack-delay', type=float, default=5.0, help='ACK delay in ms (default 5)')
+    parser.add_argument('--ack-jitter', type=float, default=0.0, help='extra random ACK delay in ms')
+    parser.add_argument('--occupied', type=float, default=20.0, help='mean seconds someone stays (default 20)')
+    parser.add_argument('--empty', type=float, default=40.0, help='mean seconds the room stays empty (default 40)')
+    parser.add_argument('--engineering', action='store_true', help='start in engineering mode')
+    parser.add_argument('--seed', type=int, default=2410)
+    args = parser.parse_args()
+
+    faults = Faults(args)
+    radars = []
+    handles = []  # keeps pty ends and serial ports open
+    endpoints = [('port', path) for path in args.port] or [('pty', None)] * args.radars
+    for index, (kind, path) in enumerate(endpoints):
+        if kind == 'pty':
+            fd, device = open_pty()
+            handles.append(device)
+            path = os.ttyname(device)
+        else:
+            fd, port = open_port(path, args.baud)
+            handles.append(port)
+        os.set_blocking(fd, False)
+        rng = random.Random(args.seed + index)
+        radar = Radar(f'radar {index} ({path})', fd, faults, rng, Room(rng, args.occupied, args.empty))
+        radar.engineering = args.engineering
+        radars.append(radar)
+        print(f'Emulating {radar.name}', flush=True)
+
+    by_fd = {radar.fd: radar for radar in radars}
+    # Background jobs ignore Ctrl-C, so a plain kill also ends with the summary
+    signal.signal(signal.SIGTERM, stop)
+    try:
+        while True:
+            now = time.monotonic()
+            timeout = max(0.0, min(radar.next_event() for radar in radars) - now)
+            readable, _, _ = select.select(list(by_fd), [], [], timeout)
+            for fd in readable:
+                by_fd[fd].receive(os.read(fd, 4096))
+            now = time.monotonic()
+            for radar in radars:
+                radar.tick(now)
+    except KeyboardInterrupt:
+        print()
+        for radar in radars:
+            print(radar.summary())
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,164 @@
+/**
+ * Worst-case loop time benchmark for the HLK-LD2410S receive path.
+ *
+ * Builds hlk_ld2410s.cpp unmodified against the host stand-ins in
+ * tools/host and feeds adversarial byte streams through the real loop():
+ * receive_(), dispatch_frame_(), publishing and logging, with the clock
+ * checked against the loop budget as on the device. The input never runs
+ * dry, as with a misconfigured baud rate or a floating RX pin. For each
+ * pattern it reports the loop time, how far the worst loop runs past the
+ * budget, frames dispatched, bytes discarded and log messages per loop.
+ *
+ * Build and run on a host:
+ *   g++ -O2 -std=gnu++17 -Itools/host -Icomponents/hlk_ld2410s -DHLK_LD2410S_ENGINEERING \
+ *       -DHLK_LD2410S_GATE_SENSORS=16 tools/parser_bench.cpp tools/host/host.cpp \
+ *       components/hlk_ld2410s/hlk_ld2410s.cpp components/hlk_ld2410s/frame_parser.cpp -o parser_bench
+ *   ./parser_bench [budget_us]
+ *
+ * Host timings are far below an ESP8266 or ESP32, so compare patterns with
+ * each other rather than reading the absolute numbers as device timings.
+ * The maximum includes host scheduler preemption; run it on an idle machine.
+ *
+ * Author: mouldybread
+ */
+
+ #include <algorithm>
+ #include <cstdio>
+ #include <cstdlib>
+ #include <random>
+ #include <vector>
+ 
+ #include "host.h"
+ #include "hlk_ld2410s.h"
+ 
+ using namespace esphome;
+ using namespace esphome::hlk_ld2410s;
+ 
+ static const size_t STREAM_SIZE = 1 << 20;
+ static const int LOOPS = 2000;
+ static const int MAX_SETUP_LOOPS = 10000;
+ 
+ // Exposes what the benchmark needs to see of the component
+ class BenchComponent : public HLKLD2410SComponent {
+  public:
+     using HLKLD2410SComponent::HLKLD2410SComponent;
+     bool commands_pending() const { return !this->command_queue_.empty(); }
+     uint32_t data_frames() const { return this->link_stats_.simple_frames + this->link_stats_.engineering_frames; }
+     uint32_t discarded_bytes() const { return this->parser_.stats().discarded_bytes; }
+ };
+ 
+ static std::vector<uint8_t> repeat(const std::vector<uint8_t> &pattern) {
+     std::vector<uint8_t> stream;
+     stream.reserve(STREAM_SIZE);
+     while (stream.size() < STREAM_SIZE) {
+         stream.insert(stream.end(), pattern.begin(), pattern.end());
+     }
+     stream.resize(STREAM_SIZE);
+     return stream;
+ }
+ 
+ static std::vector<uint8_t> random_bytes() {
+     std::mt19937 rng(2410);
+     std::vector<uint8_t> stream(STREAM_SIZE);
+     for (uint8_t &byte : stream) {
+         byte = static_cast<uint8_t>(rng());
+     }
+     return stream;
+ }
+ 
+ // Valid header and the largest length the buffer accepts, then a wrong footer
+ static std::vector<uint8_t> oversized_frames() {
+     const size_t payload = FRAME_BUFFER_SIZE - EngineeringFrame::PAYLOAD - sizeof(DATA_FRAME_FOOTER);
+     std::vector<uint8_t> frame(DATA_FRAME_HEADER, DATA_FRAME_HEADER + FRAME_HEADER_LENGTH);
+     frame.push_back(static_cast<uint8_t>(payload));
+     frame.push_back(0);
+     frame.insert(frame.end(), payload, 0x00);
+     frame.insert(frame.end(), {0xF8, 0xF7, 0xF6, 0x00});
+     return repeat(frame);
+ }
+ 
+ static std::vector<uint8_t> engineering_frames() {
+     std::vector<uint8_t> frame(DATA_FRAME_HEADER, DATA_FRAME_HEADER + FRAME_HEADER_LENGTH);
+     frame.push_back(EngineeringFrame::PAYLOAD_LENGTH);
+     frame.push_back(0);
+     frame.insert(frame.end(), EngineeringFrame::PAYLOAD_LENGTH, 0x10);
+     frame.insert(frame.end(), DATA_FRAME_FOOTER, DATA_FRAME_FOOTER + sizeof(DATA_FRAME_FOOTER));
+     return repeat(frame);
+ }
+ 
+ // Value at the given fraction of the sorted samples
+ static double percentile(const std::vector<double> &samples, double fraction) {
+     return samples[static_cast<size_t>(fraction * (samples.size() - 1))];
+ }
+ 
+ static void run(const char *name, const std::vector<uint8_t> &stream, uint32_t budget_us) {
+     uart::UARTComponent uart;
+     uart.reserve(STREAM_SIZE);
+     host::acknowledge_commands(uart);
+ 
+     BenchComponent radar(&uart);
+     sensor::Sensor distance;
+     binary_sensor::BinarySensor presence;
+     radar.set_distance_sensor(&distance);
+     radar.set_presence_sensor(&presence);
+ #ifdef HLK_LD2410S_GATE_SENSORS
+     sensor::Sensor gate_energy[HLK_LD2410S_GATE_SENSORS];
+     for (uint8_t i = 0; i < HLK_LD2410S_GATE_SENSORS; i++) {
+         radar.set_gate_energy_sensor(i, &gate_energy[i]);
+     }
+     radar.set_gate_energy_window(1000);
+ #endif
+ #ifdef HLK_LD2410S_ENGINEERING
+     radar.set_output_mode(true);
+ #endif
+     radar.set_loop_budget(budget_us);
+     radar.set_preference_key(name);
+     radar.setup();
+     for (int i = 0; i < MAX_SETUP_LOOPS && radar.commands_pending(); i++) {
+         radar.loop();
+     }
+ 
+     const uint32_t frames_before = radar.data_frames();
+     const uint32_t discarded_before = radar.discarded_bytes();
+     const uint32_t logs_before = host::log_messages;
+     size_t offset = 0;
+     std::vector<double> loops_us;
+     loops_us.reserve(LOOPS);
+     for (int loop = 0; loop < LOOPS; loop++) {
+         // Keep more waiting than one loop may read, so the input never runs dry
+         while (uart.available() < 2 * MAX_BYTES_PER_LOOP) {
+             const size_t length = std::min<size_t>(MAX_BYTES_PER_LOOP, stream.size() - offset);
+             uart.inject(stream.data() + offset, length);
+             offset = (offset + length) % stream.size();
+         }
+         const uint32_t start = micros();
+         radar.loop();
+         loops_us.push_back(micros() - start);
+     }
+ 
+     std::sort(loops_us.begin(), loops_us.end());
+     printf("%-20s %10.0f %10.0f %10.0f %10.0f %10u %10u %10.2f\n", name, percentile(loops_us, 0.5),
+            percentile(loops_us, 0.99), loops_us.back(), std::max(0.0, loops_us.back() - budget_us),
+            radar.data_frames() - frames_before, radar.discarded_bytes() - discarded_before,
+            static_cast<double>(host::log_messages - logs_before) / LOOPS);
+ }
+ 
+ int main(int argc, char **argv) {
+     const uint32_t budget_us = argc > 1 ? atoi(argv[1]) : 1000;
+     host::log_level = ESPHOME_LOG_LEVEL_NONE;
+     printf("Loop budget %u us, %u bytes per loop at most, %d loops per pattern\n\n", budget_us,
+            static_cast<unsigned>(MAX_BYTES_PER_LOOP), LOOPS);
+     printf("%-20s %10s %10s %10s %10s %10s %10s %10s\n", "pattern", "loop p50", "loop p99", "loop max", "overshoot",
+            "frames", "discarded", "logs");
+     printf("%-20s %10s %10s %10s %10s %10s %10s %10s\n", "", "us", "us", "us", "us", "", "", "/loop");
+ #ifdef HLK_LD2410S_ENGINEERING
+     run("engineering frames", engineering_frames(), budget_us);
+ #endif
+     run("random bytes", random_bytes(), budget_us);
+     run("header prefixes", repeat({0xF4, 0xF3, 0xF2}), budget_us);
+     run("config prefixes", repeat({0xFD, 0xFC, 0xFB}), budget_us);
+     run("false simple frames", repeat({0x6E, 0x6E, 0x6E, 0x6E, 0x00}), budget_us);
+     run("oversized frames", oversized_frames(), budget_us);
+     run("all 0xF4", repeat({0xF4}), budget_us);
+     return 0;
+ }
\ No newline at end of file
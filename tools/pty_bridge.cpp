@@ -0,0 +1,183 @@
+/**
+ * Runs the HLK-LD2410S component on a host against a pseudo terminal or serial port.
+ *
+ * Builds hlk_ld2410s.cpp unmodified against the host stand-ins in
+ * tools/host and wires the UART stand-in to a file descriptor: bytes read
+ * from the device are injected, and whatever the component writes goes
+ * back out. Point it at a pty from tools/ld2410s_emulator.py for a soak
+ * run without hardware, or at a USB-UART adapter wired to a real radar.
+ * setup() and loop() run against the wall clock as on the device, and the
+ * diagnostic counters are printed every report interval and on exit.
+ *
+ * Build and run on a host:
+ *   g++ -O2 -std=gnu++17 -Itools/host -Icomponents/hlk_ld2410s -DHLK_LD2410S_ENGINEERING \
+ *       -DHLK_LD2410S_GATE_SENSORS=16 -DHLK_LD2410S_FIRMWARE_SENSOR tools/pty_bridge.cpp tools/host/host.cpp \
+ *       components/hlk_ld2410s/hlk_ld2410s.cpp components/hlk_ld2410s/frame_parser.cpp -o pty_bridge -lpthread
+ *   ./pty_bridge /dev/pts/N [seconds] [report_seconds]
+ *
+ * Without a duration it runs until Ctrl-C or SIGTERM. It exits non-zero
+ * if the radar never reported its firmware version or sent no data frames,
+ * so scripts can tell a dead link from a noisy one. tools/soak.sh runs it
+ * against every radar of an emulator.
+ *
+ * Author: mouldybread
+ */
+
+ #include <cerrno>
+ #include <csignal>
+ #include <cstdio>
+ #include <cstdlib>
+ #include <fcntl.h>
+ #include <termios.h>
+ #include <unistd.h>
+ 
+ #include "host.h"
+ #include "hlk_ld2410s.h"
+ 
+ using namespace esphome;
+ using namespace esphome::hlk_ld2410s;
+ 
+ static const uint32_t LOOP_INTERVAL_MS = 2;  // sleep between loops, well under a frame at 8 Hz
+ static const size_t READ_SIZE = 256;
+ 
+ static volatile sig_atomic_t stop_requested = 0;
+ 
+ static void request_stop(int) { stop_requested = 1; }
+ 
+ // Raw 8N1 at the radar's baud rate; a pty ignores the speed
+ static int open_device(const char *path) {
+     const int fd = open(path, O_RDWR | O_NOCTTY | O_NONBLOCK);
+     if (fd < 0) {
+         return -1;
+     }
+     termios tio{};
+     if (tcgetattr(fd, &tio) == 0) {
+         cfmakeraw(&tio);
+         cfsetspeed(&tio, B115200);
+         tcsetattr(fd, TCSANOW, &tio);
+     }
+     return fd;
+ }
+ 
+ static void write_all(int fd, const uint8_t *data, size_t length) {
+     while (length > 0) {
+         const ssize_t written = write(fd, data, length);
+         if (written < 0) {
+             if (errno == EAGAIN || errno == EINTR) {
+                 usleep(100);
+                 continue;
+             }
+             perror("write");
+             return;
+         }
+         data += written;
+         length -= written;
+     }
+ }
+ 
+ struct Counters {
+     sensor::Sensor sensors[DIAGNOSTIC_SENSOR_COUNT];
+ 
+     float get(DiagnosticSensor type) const { return this->sensors[static_cast<uint8_t>(type)].state; }
+     uint32_t frames() const {
+         return this->get(DiagnosticSensor::SIMPLE_FRAMES) + this->get(DiagnosticSensor::ENGINEERING_FRAMES);
+     }
+ };
+ 
+ static void report(const char *device, uint32_t now, const Counters &counters, uint32_t presence_changes) {
+     printf("%s %6us frames %u (engineering %.0f) presence changes %u bad footers %.0f overflows %.0f "
+            "ack timeouts %.0f failed %.0f ack ms %.0f/%.0f/%.0f loop p99 %.0f us\n",
+            device, now / 1000, counters.frames(), counters.get(DiagnosticSensor::ENGINEERING_FRAMES), presence_changes,
+            counters.get(DiagnosticSensor::BAD_FOOTERS), counters.get(DiagnosticSensor::BUFFER_OVERFLOWS),
+            counters.get(DiagnosticSensor::ACK_TIMEOUTS), counters.get(DiagnosticSensor::FAILED_RESPONSES),
+            counters.get(DiagnosticSensor::ACK_LATENCY_MIN), counters.get(DiagnosticSensor::ACK_LATENCY_AVG),
+            counters.get(DiagnosticSensor::ACK_LATENCY_MAX), counters.get(DiagnosticSensor::LOOP_TIME_P99));
+     fflush(stdout);
+ }
+ 
+ int main(int argc, char **argv) {
+     if (argc < 2) {
+         fprintf(stderr, "usage: %s DEVICE [seconds] [report_seconds]\n", argv[0]);
+         return 2;
+     }
+     const char *device = argv[1];
+     const uint32_t duration_ms = argc > 2 ? atoi(argv[2]) * 1000 : 0;
+     const uint32_t report_ms = argc > 3 ? atoi(argv[3]) * 1000 : 10000;
+ 
+     const int fd = open_device(device);
+     if (fd < 0) {
+         perror(device);
+         return 2;
+     }
+     signal(SIGINT, request_stop);
+     signal(SIGTERM, request_stop);
+     host::log_level = ESPHOME_LOG_LEVEL_WARN;
+ 
+     uart::UARTComponent uart;
+     uart.set_tx_callback([fd](const uint8_t *data, size_t length) { write_all(fd, data, length); });
+ 
+     HLKLD2410SComponent radar(&uart);
+     sensor::Sensor distance;
+     binary_sensor::BinarySensor presence;
+     Counters counters;
+     radar.set_distance_sensor(&distance);
+     radar.set_presence_sensor(&presence);
+     for (uint8_t i = 0; i < DIAGNOSTIC_SENSOR_COUNT; i++) {
+         radar.set_diagnostic_sensor(static_cast<DiagnosticSensor>(i), &counters.sensors[i]);
+     }
+     radar.set_diagnostics_interval(report_ms);
+ #ifdef HLK_LD2410S_FIRMWARE_SENSOR
+     text_sensor::TextSensor firmware;
+     radar.set_firmware_version_sensor(&firmware);
+ #endif
+ #ifdef HLK_LD2410S_GATE_SENSORS
+     sensor::Sensor gate_energy[HLK_LD2410S_GATE_SENSORS];
+     for (uint8_t i = 0; i < HLK_LD2410S_GATE_SENSORS; i++) {
+         radar.set_gate_energy_sensor(i, &gate_energy[i]);
+     }
+ #endif
+ #ifdef HLK_LD2410S_ENGINEERING
+     radar.set_output_mode(true);
+ #endif
+     radar.set_preference_key(device);
+     radar.setup();
+ 
+     uint8_t buffer[READ_SIZE];
+     uint32_t presence_changes = 0;
+     bool last_presence = false;
+     uint32_t next_report = report_ms;
+     while (!stop_requested && (duration_ms == 0 || millis() < duration_ms)) {
+         ssize_t length;
+         while ((length = read(fd, buffer, sizeof(buffer))) > 0) {
+             uart.inject(buffer, length);
+         }
+         if (length == 0 || (length < 0 && errno != EAGAIN && errno != EINTR)) {
+             // The other end closed, e.g. the emulator stopped
+             fprintf(stderr, "%s: device closed\n", device);
+             break;
+         }
+         radar.loop();
+         if (presence.has_state() && presence.state != last_presence) {
+             presence_changes++;
+             last_presence = presence.state;
+         }
+         // Counters are published with the diagnostics, so report right after they refresh
+         if (millis() >= next_report) {
+             report(device, millis(), counters, presence_changes);
+             next_report += report_ms;
+         }
+         usleep(LOOP_INTERVAL_MS * 1000);
+     }
+ 
+     report(device, millis(), counters, presence_changes);
+     bool ok = counters.frames() > 0;
+ #ifdef HLK_LD2410S_FIRMWARE_SENSOR
+     printf("%s firmware %s\n", device, firmware.publishes > 0 ? firmware.state.c_str() : "never reported");
+     ok &= firmware.publishes > 0;
+ #endif
+     printf("%s %s\n", device, ok ? "PASS" : "FAILED");
+     fflush(stdout);
+     // With HLK_LD2410S_RX_TASK the receive task keeps reading the UART, so leave
+     // without destroying it, as a device never tears the component down
+     _exit(ok ? 0 : 1);
+ }
\ No newline at end of file
@@ -0,0 +1,259 @@
+/**
+ * Replay benchmark for the HLK-LD2410S receive and command path.
+ *
+ * Builds hlk_ld2410s.cpp unmodified against the host stand-ins in
+ * tools/host and replays byte streams through the real component: setup()
+ * runs its configuration session against a mock radar that acknowledges
+ * every command, then each loop() gets the bytes 115200 baud delivers
+ * between two 16 ms loops. Parsing, dispatch, publishing and logging all
+ * run as on the device.
+ *
+ * Per stream it reports data frames decoded per second of loop() time, loop()
+ * time per byte, heap allocations and log messages per frame (a counting
+ * global operator new, and the host log sink), and the worst and p99 loop()
+ * time. Allocation and log counts are exact and comparable across versions
+ * of the component; times are host times, so compare them with each other.
+ * A second table runs one to three radars side by side on the engineering
+ * stream and reports the object size and the loop() time of all of them.
+ *
+ * Build and run on a host:
+ *   g++ -O2 -std=gnu++17 -Itools/host -Icomponents/hlk_ld2410s -DHLK_LD2410S_ENGINEERING \
+ *       -DHLK_LD2410S_GATE_SENSORS=16 tools/replay_bench.cpp tools/host/host.cpp \
+ *       components/hlk_ld2410s/hlk_ld2410s.cpp components/hlk_ld2410s/frame_parser.cpp -o replay_bench
+ *   ./replay_bench [capture.bin ...]
+ *
+ * Captures are raw radar output, e.g. from tools/flight_recorder.py --replay,
+ * and are replayed in engineering mode after the built-in streams.
+ *
+ * Author: mouldybread
+ */
+
+ #include <algorithm>
+ #include <chrono>
+ #include <cstdio>
+ #include <cstdlib>
+ #include <fstream>
+ #include <iterator>
+ #include <memory>
+ #include <new>
+ #include <random>
+ #include <vector>
+ 
+ #include "host.h"
+ #include "hlk_ld2410s.h"
+ 
+ using namespace esphome;
+ using namespace esphome::hlk_ld2410s;
+ using Clock = std::chrono::steady_clock;
+ 
+ static const size_t STREAM_SIZE = 1 << 20;
+ static const size_t BYTES_PER_LOOP = 184;  // 115200 baud, 16 ms loop interval
+ static const int MAX_SETUP_LOOPS = 10000;
+ static const size_t MAX_RADARS = 3;
+ 
+ static uint64_t allocations = 0;
+ 
+ void *operator new(size_t size) {
+     allocations++;
+     void *ptr = malloc(size == 0 ? 1 : size);
+     if (ptr == nullptr) {
+         throw std::bad_alloc();
+     }
+     return ptr;
+ }
+ void *operator new[](size_t size) { return operator new(size); }
+ void operator delete(void *ptr) noexcept { free(ptr); }
+ void operator delete[](void *ptr) noexcept { free(ptr); }
+ void operator delete(void *ptr, size_t) noexcept { free(ptr); }
+ void operator delete[](void *ptr, size_t) noexcept { free(ptr); }
+ 
+ // Exposes what the benchmark needs to see of the component
+ class ReplayComponent : public HLKLD2410SComponent {
+  public:
+     using HLKLD2410SComponent::HLKLD2410SComponent;
+     bool commands_pending() const { return !this->command_queue_.empty(); }
+     uint32_t data_frames() const { return this->link_stats_.simple_frames + this->link_stats_.engineering_frames; }
+ };
+ 
+ static std::vector<uint8_t> simple_frame(std::mt19937 &rng) {
+     const uint8_t state = rng() % 4 == 0 ? 0x00 : 0x02;
+     return {SIMPLE_FRAME_HEAD, state, static_cast<uint8_t>(rng() % 250), 0x00, SIMPLE_FRAME_TAIL};
+ }
+ 
+ static std::vector<uint8_t> engineering_frame(std::mt19937 &rng) {
+     std::vector<uint8_t> frame(EngineeringFrame::LENGTH, 0x00);
+     std::copy(DATA_FRAME_HEADER, DATA_FRAME_HEADER + FRAME_HEADER_LENGTH, frame.begin());
+     EngineeringFrame::Length::write(frame.data(), EngineeringFrame::PAYLOAD_LENGTH);
+     EngineeringFrame::Type::write(frame.data(), 0x01);
+     EngineeringFrame::State::write(frame.data(), rng() % 4 == 0 ? 0 : 2);
+     EngineeringFrame::Distance::write(frame.data(), rng() % 800);
+     for (uint8_t i = 0; i < MAX_GATES; i++) {
+         frame[EngineeringFrame::GATE_ENERGY + i] = rng() % 100;
+     }
+     std::copy(DATA_FRAME_FOOTER, DATA_FRAME_FOOTER + sizeof(DATA_FRAME_FOOTER), frame.begin() + EngineeringFrame::FOOTER);
+     return frame;
+ }
+ 
+ template<typename Generator> static std::vector<uint8_t> frames(Generator generate) {
+     std::mt19937 rng(2410);
+     std::vector<uint8_t> stream;
+     while (stream.size() < STREAM_SIZE) {
+         const std::vector<uint8_t> frame = generate(rng);
+         stream.insert(stream.end(), frame.begin(), frame.end());
+     }
+     return stream;
+ }
+ 
+ // Engineering frames with bursts of line noise between them
+ static std::vector<uint8_t> noisy_frames() {
+     return frames([](std::mt19937 &rng) {
+         std::vector<uint8_t> bytes(rng() % 64);
+         for (uint8_t &byte : bytes) {
+             byte = static_cast<uint8_t>(rng());
+         }
+         const std::vector<uint8_t> frame = engineering_frame(rng);
+         bytes.insert(bytes.end(), frame.begin(), frame.end());
+         return bytes;
+     });
+ }
+ 
+ // Every other engineering frame is cut off somewhere after its header
+ static std::vector<uint8_t> truncated_frames() {
+     return frames([](std::mt19937 &rng) {
+         std::vector<uint8_t> bytes = engineering_frame(rng);
+         bytes.resize(FRAME_HEADER_LENGTH + rng() % (EngineeringFrame::LENGTH - FRAME_HEADER_LENGTH));
+         const std::vector<uint8_t> frame = engineering_frame(rng);
+         bytes.insert(bytes.end(), frame.begin(), frame.end());
+         return bytes;
+     });
+ }
+ 
+ // One radar with its UART, mock and sensors, configured and done with its boot session
+ struct Radar {
+     Radar(const char *name, bool engineering) : radar(&uart) {
+         uart.reserve(STREAM_SIZE);
+         host::acknowledge_commands(uart);
+         radar.set_distance_sensor(&distance);
+         radar.set_presence_sensor(&presence);
+ #ifdef HLK_LD2410S_GATE_SENSORS
+         for (uint8_t i = 0; i < HLK_LD2410S_GATE_SENSORS; i++) {
+             radar.set_gate_energy_sensor(i, &gate_energy[i]);
+         }
+         radar.set_gate_energy_window(1000);
+ #endif
+         radar.set_output_mode(engineering);
+         radar.set_preference_key(name);
+         radar.setup();
+         for (int i = 0; i < MAX_SETUP_LOOPS && radar.commands_pending(); i++) {
+             radar.loop();
+         }
+     }
+ 
+     uart::UARTComponent uart;
+     ReplayComponent radar;
+     sensor::Sensor distance;
+     binary_sensor::BinarySensor presence;
+ #ifdef HLK_LD2410S_GATE_SENSORS
+     sensor::Sensor gate_energy[HLK_LD2410S_GATE_SENSORS];
+ #endif
+ };
+ 
+ static void replay(const char *name, const std::vector<uint8_t> &stream, bool engineering) {
+     Radar node(name, engineering);
+     uart::UARTComponent &uart = node.uart;
+     ReplayComponent &radar = node.radar;
+ 
+     const uint64_t allocations_before = allocations;
+     const uint32_t logs_before = host::log_messages;
+     const uint32_t frames_before = radar.data_frames();
+     std::vector<double> loops_us;
+     loops_us.reserve(stream.size() / BYTES_PER_LOOP + 2);
+     double total_us = 0.0;
+     for (size_t offset = 0; offset < stream.size(); offset += BYTES_PER_LOOP) {
+         uart.inject(stream.data() + offset, std::min(BYTES_PER_LOOP, stream.size() - offset));
+         const Clock::time_point start = Clock::now();
+         radar.loop();
+         const double loop_us = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+         total_us += loop_us;
+         loops_us.push_back(loop_us);
+     }
+     const uint32_t frames = radar.data_frames() - frames_before;
+     const double per_frame = frames > 0 ? 1.0 / frames : 0.0;
+ 
+     std::sort(loops_us.begin(), loops_us.end());
+     printf("%-20s %8u %10.0f %8.1f %8.2f %8.2f %8.1f %8.1f\n", name, frames, frames / (total_us / 1e6),
+            total_us * 1000.0 / stream.size(), (allocations - allocations_before) * per_frame,
+            (host::log_messages - logs_before) * per_frame, loops_us[loops_us.size() * 99 / 100], loops_us.back());
+ }
+ 
+ // Every radar gets the same stream; one sample is the loop() of all of them
+ static void replay_radars(size_t count, const std::vector<uint8_t> &stream) {
+     std::vector<std::unique_ptr<Radar>> radars;
+     for (size_t i = 0; i < count; i++) {
+         const char *names[MAX_RADARS] = {"radar_a", "radar_b", "radar_c"};
+         radars.emplace_back(new Radar(names[i], true));
+     }
+ 
+     uint32_t frames_before = 0;
+     for (const std::unique_ptr<Radar> &radar : radars) {
+         frames_before += radar->radar.data_frames();
+     }
+     std::vector<double> loops_us;
+     loops_us.reserve(stream.size() / BYTES_PER_LOOP + 2);
+     for (size_t offset = 0; offset < stream.size(); offset += BYTES_PER_LOOP) {
+         for (const std::unique_ptr<Radar> &radar : radars) {
+             radar->uart.inject(stream.data() + offset, std::min(BYTES_PER_LOOP, stream.size() - offset));
+         }
+         const Clock::time_point start = Clock::now();
+         for (const std::unique_ptr<Radar> &radar : radars) {
+             radar->radar.loop();
+         }
+         loops_us.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+     }
+     uint32_t frames = 0;
+     for (const std::unique_ptr<Radar> &radar : radars) {
+         frames += radar->radar.data_frames();
+     }
+ 
+     std::sort(loops_us.begin(), loops_us.end());
+     double total_us = 0.0;
+     for (double loop_us : loops_us) {
+         total_us += loop_us;
+     }
+     printf("%-20zu %8u %8.1f %8.1f %8.1f\n", count, frames - frames_before, total_us / loops_us.size(),
+            loops_us[loops_us.size() * 99 / 100], loops_us.back());
+ }
+ 
+ int main(int argc, char **argv) {
+     host::log_level = ESPHOME_LOG_LEVEL_NONE;
+     printf("%zu bytes per stream, %zu bytes per loop\n\n", STREAM_SIZE, BYTES_PER_LOOP);
+     printf("%-20s %8s %10s %8s %8s %8s %8s %8s\n", "stream", "frames", "frames/s", "ns/byte", "allocs", "logs",
+            "loop p99", "loop max");
+     printf("%-20s %8s %10s %8s %8s %8s %8s %8s\n", "", "", "", "", "/frame", "/frame", "us", "us");
+     replay("simple frames", frames(simple_frame), false);
+ #ifdef HLK_LD2410S_ENGINEERING
+     replay("engineering frames", frames(engineering_frame), true);
+     replay("noisy line", noisy_frames(), true);
+     replay("truncated frames", truncated_frames(), true);
+ #endif
+     for (int i = 1; i < argc; i++) {
+         std::ifstream file(argv[i], std::ios::binary);
+         if (!file) {
+             fprintf(stderr, "Cannot read %s\n", argv[i]);
+             return 1;
+         }
+         const std::vector<uint8_t> capture((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+         replay(argv[i], capture, true);
+     }
+ 
+ #ifdef HLK_LD2410S_ENGINEERING
+     printf("\nsizeof(HLKLD2410SComponent) = %zu bytes\n\n", sizeof(HLKLD2410SComponent));
+     printf("%-20s %8s %8s %8s %8s\n", "radars", "frames", "loop avg", "loop p99", "loop max");
+     printf("%-20s %8s %8s %8s %8s\n", "", "", "us", "us", "us");
+     const std::vector<uint8_t> stream = frames(engineering_frame);
+     for (size_t count = 1; count <= MAX_RADARS; count++) {
+         replay_radars(count, stream);
+     }
+ #endif
+     return 0;
+ }
\ No newline at end of file
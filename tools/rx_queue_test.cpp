@@ -0,0 +1,159 @@
+/**
+ * Two-thread test of the rx_task hand-off: FrameParser and FrameQueue.
+ *
+ * A std::thread plays the receive task. It feeds an engineering frame
+ * stream with line noise through the parser, pushes every frame into the
+ * queue and keeps the shared counters the way read_data_() does. The main
+ * thread plays loop(). It pops at an uneven pace so the queue both drains
+ * and overflows, and it reads the counters while they change.
+ *
+ * The test checks that every frame arrives intact and in order, that frames
+ * received plus frames dropped equal frames sent, and that the counters
+ * loop() sees add up at the end. Build it with ThreadSanitizer to also
+ * check the hand-off for data races:
+ *   g++ -O1 -g -std=gnu++17 -fsanitize=thread -DHLK_LD2410S_RX_TASK -Icomponents/hlk_ld2410s \
+ *       tools/rx_queue_test.cpp components/hlk_ld2410s/frame_parser.cpp -o rx_queue_test -lpthread
+ *   ./rx_queue_test
+ *
+ * Author: mouldybread
+ */
+
+ #include <algorithm>
+ #include <atomic>
+ #include <chrono>
+ #include <cstdio>
+ #include <thread>
+ #include <vector>
+ 
+ #include "diagnostics.h"
+ #include "frame_parser.h"
+ #include "frame_queue.h"
+ 
+ using namespace esphome::hlk_ld2410s;
+ 
+ static const uint32_t FRAMES = 200000;
+ static const size_t BYTES_PER_READ = 64;
+ static const size_t NOISE_EVERY = 7;  // frames between bursts of noise
+ static const size_t NOISE_BYTES = 5;
+ 
+ #ifndef HLK_LD2410S_RX_TASK
+ #error "Build with -DHLK_LD2410S_RX_TASK so the shared counters are the ones the receive task uses"
+ #endif
+ 
+ // Everything the receive task owns, plus what it shares with loop()
+ struct Receiver {
+     FrameParser parser;
+     ReceivedFrame frame;
+     FrameQueue queue;
+     TaskCounter overflows{0};
+     ParserStatsSnapshot parser_stats;
+     std::atomic<bool> done{false};
+ 
+     // Same steps as HLKLD2410SComponent::read_data_() with rx_task
+     void read(const uint8_t *data, size_t length) {
+         for (size_t i = 0; i < length; i++) {
+             const FrameType type = this->parser.feed(data[i]);
+             if (type == FrameType::NONE) {
+                 continue;
+             }
+             this->frame.type = type;
+             this->frame.length = this->parser.size();
+             std::copy(this->parser.data(), this->parser.data() + this->parser.size(), this->frame.data.begin());
+             if (!this->queue.push(this->frame)) {
+                 this->overflows++;
+             }
+         }
+         this->parser_stats.store(this->parser.stats());
+     }
+ };
+ 
+ // The sequence number goes into the first four gate energies
+ static void write_frame(std::vector<uint8_t> &stream, uint32_t sequence) {
+     std::vector<uint8_t> frame(EngineeringFrame::LENGTH, 0x00);
+     std::copy(DATA_FRAME_HEADER, DATA_FRAME_HEADER + FRAME_HEADER_LENGTH, frame.begin());
+     EngineeringFrame::Length::write(frame.data(), EngineeringFrame::PAYLOAD_LENGTH);
+     EngineeringFrame::Type::write(frame.data(), 0x01);
+     EngineeringFrame::State::write(frame.data(), 2);
+     EngineeringFrame::Distance::write(frame.data(), sequence % 800);
+     Field<EngineeringFrame::GATE_ENERGY, uint32_t>::write(frame.data(), sequence);
+     std::copy(DATA_FRAME_FOOTER, DATA_FRAME_FOOTER + sizeof(DATA_FRAME_FOOTER), frame.begin() + EngineeringFrame::FOOTER);
+     stream.insert(stream.end(), frame.begin(), frame.end());
+ }
+ 
+ static bool check(bool condition, const char *what) {
+     if (!condition) {
+         fprintf(stderr, "FAIL: %s\n", what);
+     }
+     return condition;
+ }
+ 
+ int main() {
+     std::vector<uint8_t> stream;
+     uint32_t noise = 0;
+     for (uint32_t sequence = 0; sequence < FRAMES; sequence++) {
+         write_frame(stream, sequence);
+         if (sequence % NOISE_EVERY == 0) {
+             // Never a frame start, so the parser discards each byte while hunting
+             stream.insert(stream.end(), NOISE_BYTES, 0x00);
+             noise += NOISE_BYTES;
+         }
+     }
+ 
+     Receiver receiver;
+     std::thread task([&receiver, &stream]() {
+         for (size_t offset = 0; offset < stream.size(); offset += BYTES_PER_READ) {
+             receiver.read(stream.data() + offset, std::min(BYTES_PER_READ, stream.size() - offset));
+             // Stands in for the time the UART takes to deliver the next read
+             std::this_thread::yield();
+         }
+         receiver.done = true;
+     });
+ 
+     bool ok = true;
+     uint32_t received = 0;
+     uint32_t last_sequence = 0;
+     uint32_t last_discarded = 0;
+     uint32_t pops = 0;
+     ReceivedFrame frame;
+     while (true) {
+         const bool finished = receiver.done;
+         if (!receiver.queue.pop(frame)) {
+             if (finished && receiver.queue.empty()) {
+                 break;
+             }
+             std::this_thread::yield();
+             continue;
+         }
+         // Fall behind now and then so the producer meets a full queue
+         if (++pops % 1000 == 0) {
+             std::this_thread::sleep_for(std::chrono::microseconds(200));
+         }
+ 
+         const uint32_t sequence = Field<EngineeringFrame::GATE_ENERGY, uint32_t>::read(frame.data.data());
+         ok &= check(frame.type == FrameType::ENGINEERING && frame.length == EngineeringFrame::LENGTH, "frame type and length");
+         ok &= check(std::equal(DATA_FRAME_FOOTER, DATA_FRAME_FOOTER + sizeof(DATA_FRAME_FOOTER),
+                                frame.data.begin() + EngineeringFrame::FOOTER), "frame footer");
+         ok &= check(received == 0 || sequence > last_sequence, "frames in order");
+         ok &= check(EngineeringFrame::Distance::read(frame.data.data()) == sequence % 800, "frame payload");
+         last_sequence = sequence;
+         received++;
+ 
+         // What publish_diagnostics_() reads while the task keeps counting
+         const uint32_t discarded = receiver.parser_stats.discarded_bytes;
+         ok &= check(discarded >= last_discarded, "discarded bytes never go back");
+         last_discarded = discarded;
+         if (!ok) {
+             break;
+         }
+     }
+     task.join();
+ 
+     const uint32_t overflows = receiver.overflows;
+     printf("%u frames sent, %u received, %u dropped on a full queue\n", FRAMES, received, overflows);
+     ok &= check(received + overflows == FRAMES, "received plus dropped equals sent");
+     ok &= check(receiver.parser_stats.discarded_bytes == noise, "discarded bytes equal the noise sent");
+     ok &= check(receiver.parser_stats.bad_footers == 0 && receiver.parser_stats.overflows == 0, "no rejected frames");
+     ok &= check(overflows > 0, "the queue overflowed at least once");
+     printf(ok ? "PASS\n" : "FAILED\n");
+     return ok ? 0 : 1;
+ }
\ No newline at end of file
@@ -0,0 +1,94 @@
+#!/usr/bin/env bash
+# Soak run of the HLK-LD2410S component against emulated radars, no hardware needed.
+#
+# Builds tools/pty_bridge.cpp, starts tools/ld2410s_emulator.py with one pty
+# per radar and runs a bridge against each pty for the given time. Anything
+# after -- goes to the emulator, so faults can be injected:
+#   tools/soak.sh [seconds] [radars] [-- emulator options]
+#   tools/soak.sh 600 3 -- --ack-jitter 40 --drop-ack 0.05 --partial-frame 0.02 --garbage 0.1
+#
+# Prints each bridge's counters every report interval, then the final
+# counters of both sides. Compare the emulator's injected faults and ACK
+# delays with the bridges' bad footers, ACK timeouts and ACK latency. Exits
+# non-zero if any bridge never completed the handshake or received no frames.
+# Set BUILD_FLAGS to change the feature defines the component is built with.
+#
+# Created by github.com/mouldybread
+
+set -euo pipefail
+
+SECONDS_TO_RUN=${1:-300}
+RADARS=${2:-3}
+shift $(( $# < 2 ? $# : 2 ))
+if [[ ${1:-} == -- ]]; then
+    shift
+fi
+REPORT_SECONDS=${REPORT_SECONDS:-30}
+BUILD_FLAGS=${BUILD_FLAGS:--DHLK_LD2410S_ENGINEERING -DHLK_LD2410S_GATE_SENSORS=16 -DHLK_LD2410S_FIRMWARE_SENSOR}
+
+ROOT=$(cd "$(dirname "$0")/.." && pwd)
+WORK=$(mktemp -d)
+EMULATOR_PID=
+BRIDGE_PIDS=()
+
+cleanup() {
+    for pid in "${BRIDGE_PIDS[@]}" $EMULATOR_PID; do
+        kill "$pid" 2>/dev/null || true
+    done
+    rm -rf "$WORK"
+}
+trap cleanup EXIT
+
+echo "Building the bridge"
+# shellcheck disable=SC2086  # BUILD_FLAGS is a list of flags
+g++ -O2 -std=gnu++17 -I"$ROOT/tools/host" -I"$ROOT/components/hlk_ld2410s" $BUILD_FLAGS \
+    "$ROOT/tools/pty_bridge.cpp" "$ROOT/tools/host/host.cpp" \
+    "$ROOT/components/hlk_ld2410s/hlk_ld2410s.cpp" "$ROOT/components/hlk_ld2410s/frame_parser.cpp" \
+    -o "$WORK/pty_bridge" -lpthread
+
+python3 -u "$ROOT/tools/ld2410s_emulator.py" --radars "$RADARS" "$@" > "$WORK/emulator.log" 2>&1 &
+EMULATOR_PID=$!
+
+# The emulator prints one "Emulating radar N (/dev/pts/M)" line per radar
+for _ in $(seq 50); do
+    if [[ $(grep -c '^Emulating' "$WORK/emulator.log" || true) -ge $RADARS ]]; then
+        break
+    fi
+    if ! kill -0 "$EMULATOR_PID" 2>/dev/null; then
+        cat "$WORK/emulator.log"
+        exit 1
+    fi
+    sleep 0.1
+done
+mapfile -t PTYS < <(sed -n 's/^Emulating .*(\(.*\))$/\1/p' "$WORK/emulator.log")
+if [[ ${#PTYS[@]} -lt $RADARS ]]; then
+    echo "Emulator did not start $RADARS radars" >&2
+    cat "$WORK/emulator.log"
+    exit 1
+fi
+
+echo "Soaking ${PTYS[*]} for ${SECONDS_TO_RUN}s"
+for pty in "${PTYS[@]}"; do
+    "$WORK/pty_bridge" "$pty" "$SECONDS_TO_RUN" "$REPORT_SECONDS" &
+    BRIDGE_PIDS+=($!)
+done
+
+FAILED=0
+for pid in "${BRIDGE_PIDS[@]}"; do
+    wait "$pid" || FAILED=1
+done
+BRIDGE_PIDS=()
+
+# SIGTERM makes the emulator print its summary
+kill -TERM "$EMULATOR_PID"
+wait "$EMULATOR_PID" || true
+EMULATOR_PID=
+echo
+echo "Emulator:"
+sed '/^Emulating/d' "$WORK/emulator.log"
+
+if [[ $FAILED -ne 0 ]]; then
+    echo "Soak FAILED"
+    exit 1
+fi
+echo "Soak passed"